@@ -40,4 +40,14 @@ typedef double f64;  // 64 bit float type
 #define reserve_zero(type)      (type*)calloc(1, sizeof(type))   // Allocates a new element in the heap and zeroes it
 #define reserve_zero_a(type, n) (type*)calloc(n, sizeof(type))   // Allocates a new array of elements in the heap and zeroes it
 
+// Allocates a new element in the heap aligned to its type, for types over-aligned with `_Alignas`. Freed with `free_aligned`
+#if defined(_WIN32)
+#include <malloc.h>  // _aligned_malloc, _aligned_free
+#define reserve_aligned_t(type) (type*)_aligned_malloc(sizeof(type), _Alignof(type))
+#define free_aligned(memory)    _aligned_free(memory)
+#else
+#define reserve_aligned_t(type) (type*)aligned_alloc(_Alignof(type), sizeof(type))
+#define free_aligned(memory)    free(memory)
+#endif
+
 #endif  // __TYPES_H__
\ No newline at end of file
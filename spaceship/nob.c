@@ -7,52 +7,114 @@
 #define SRC_FOLDER   "src/"
 #define LIB_FOLDER   "lib/"
 
-void nob_base(Nob_Cmd* cmd) {
+// Compiler and flags shared by every target
+void nob_common(Nob_Cmd* cmd) {
     nob_cc(cmd);        // cc
     nob_cc_flags(cmd);  // -Wall -Wextra
     nob_cmd_append(cmd, "-I" SRC_FOLDER);
+    nob_cmd_append(cmd, "-ffp-contract=off");  // Keep the scalar and SIMD collision tests bit-identical
+    nob_cmd_append(cmd, "-pthread");           // Worker threads of the job system
+}
+
+// Sources of the game, shared by every target
+void nob_game_sources(Nob_Cmd* cmd) {
     nob_cc_inputs(cmd,
-                  SRC_FOLDER "main.c",                  // entrypoint
-                  SRC_FOLDER "types/arena.c"            // arena
-                  SRC_FOLDER "types/float16.c"          // float16
-                  SRC_FOLDER "types/object_pool.c"      // object pool
-                  SRC_FOLDER "types/arena.c"            // arena
-                  SRC_FOLDER "utils/extra_math.c"       // extra raymath
-                  SRC_FOLDER "utils/memory_utils.c"     // memory utilities
-                  SRC_FOLDER "input/input-handler.c"    // input handler
-                  SRC_FOLDER "entities/collisions.c"    // collisions
-                  SRC_FOLDER "entities/entities.c"      // entities
-                  SRC_FOLDER "abilities/abilites.c"     // abilities
-                  SRC_FOLDER "lifecycles/game_clear.c"  // game clearing
-                  SRC_FOLDER "lifecycles/game_draw.c"   // game drawing
-                  SRC_FOLDER "lifecycles/game_frame.c"  // game frame logic
-                  SRC_FOLDER "lifecycles/game_init.c"   // game initialization
-                  SRC_FOLDER "lifecycles/game_loop.c"   // game loop
-                  SRC_FOLDER "lifecycles/game_state.c"  // game state
-                  SRC_FOLDER "debug/debug_panel.c"      // debug panel
-                  SRC_FOLDER "debug/game_debug.c"       // game debug utils
+                  SRC_FOLDER "types/arena.c",             // arena
+                  SRC_FOLDER "types/ecs.c",               // entity component system
+                  SRC_FOLDER "types/float16.c",           // float16
+                  SRC_FOLDER "types/jobs.c",              // job system
+                  SRC_FOLDER "types/object_pool.c",       // object pool
+                  SRC_FOLDER "utils/extra_math.c",        // extra raymath
+                  SRC_FOLDER "utils/memory_utils.c",      // memory utilities
+                  SRC_FOLDER "utils/random.c",            // random numbers and hashes
+                  SRC_FOLDER "input/input-handler.c",     // input handler
+                  SRC_FOLDER "entities/collisions.c",     // collisions
+                  SRC_FOLDER "entities/entities.c",       // entities
+                  SRC_FOLDER "abilities/abilities.c",     // abilities
+                  SRC_FOLDER "lifecycles/game_clear.c",   // game clearing
+                  SRC_FOLDER "lifecycles/game_draw.c",    // game drawing
+                  SRC_FOLDER "lifecycles/game_frame.c",   // game frame logic
+                  SRC_FOLDER "lifecycles/game_init.c",    // game initialization
+                  SRC_FOLDER "lifecycles/game_loop.c",    // game loop
+                  SRC_FOLDER "lifecycles/game_replay.c",  // game replays
+                  SRC_FOLDER "lifecycles/game_state.c",   // game state
+                  SRC_FOLDER "debug/debug_panel.c",       // debug panel
+                  SRC_FOLDER "debug/game_debug.c"         // game debug utils
     );
+}
+
+void nob_base(Nob_Cmd* cmd) {
+    nob_common(cmd);
+    nob_cc_inputs(cmd, SRC_FOLDER "main.c");  // entrypoint
+    nob_game_sources(cmd);
     nob_cmd_append(cmd, "-L" LIB_FOLDER, "-lraylib", "-lopengl32", "-lgdi32", "-lwinmm", "-lm");
 }
 
+// Simulation without window, textures nor fonts. The platform layer of raylib is stubbed, so it builds and runs without a GPU
+void nob_headless(Nob_Cmd* cmd) {
+    nob_common(cmd);
+    nob_cmd_append(cmd, "-DTESTING");  // Scenarios spawn the stress tests through the testing inputs
+    nob_cc_inputs(cmd,
+                  SRC_FOLDER "main_headless.c",      // entrypoint with the scenario runner
+                  SRC_FOLDER "platform/headless.c"   // stubbed platform layer
+    );
+    nob_game_sources(cmd);
+    nob_cmd_append(cmd, "-lm");
+}
+
+// Benchmarks of the pools, memory routines, broadphases and entity systems, run on the stubbed platform of the headless build
+void nob_bench(Nob_Cmd* cmd) {
+    nob_common(cmd);
+    nob_cc_inputs(cmd,
+                  SRC_FOLDER "main_bench.c",         // entrypoint with the benchmarks
+                  SRC_FOLDER "platform/headless.c"   // stubbed platform layer
+    );
+    nob_game_sources(cmd);
+    nob_cmd_append(cmd, "-lm");
+}
+
+// Usage:
+//   nob           Builds every target
+//   nob <target>  Builds a single target: release, debug, headless or bench. The headless and bench ones do not need raylib
 int main(int argc, char** argv) {
     NOB_GO_REBUILD_URSELF(argc, argv);
 
     if (!nob_mkdir_if_not_exists(BUILD_FOLDER)) return 1;
 
+    const char* target = argc > 1 ? argv[1] : NULL;
     Nob_Cmd cmd = {0};
 
-    nob_base(&cmd);
-    nob_cmd_append(&cmd, "-O3");
-    nob_cc_output(&cmd, BUILD_FOLDER EXECUTABLE_NAME "_release");
+    if (target == NULL || strcmp(target, "release") == 0) {
+        nob_base(&cmd);
+        nob_cmd_append(&cmd, "-O3");
+        nob_cc_output(&cmd, BUILD_FOLDER EXECUTABLE_NAME "_release");
+
+        if (!nob_cmd_run(&cmd)) return 1;
+    }
+
+    if (target == NULL || strcmp(target, "debug") == 0) {
+        nob_base(&cmd);
+        nob_cmd_append(&cmd, "-g", "-DDEBUG");
+        nob_cc_output(&cmd, BUILD_FOLDER EXECUTABLE_NAME "_debug");
+
+        if (!nob_cmd_run(&cmd)) return 1;
+    }
+
+    if (target == NULL || strcmp(target, "headless") == 0) {
+        nob_headless(&cmd);
+        nob_cmd_append(&cmd, "-O3");
+        nob_cc_output(&cmd, BUILD_FOLDER EXECUTABLE_NAME "_headless");
 
-    if (!nob_cmd_run(&cmd)) return 1;
+        if (!nob_cmd_run(&cmd)) return 1;
+    }
 
-    nob_base(&cmd);
-    nob_cmd_append(&cmd, "-g", "-DDEBUG");
-    nob_cc_output(&cmd, BUILD_FOLDER EXECUTABLE_NAME "_debug");
+    if (target == NULL || strcmp(target, "bench") == 0) {
+        nob_bench(&cmd);
+        nob_cmd_append(&cmd, "-O3");
+        nob_cc_output(&cmd, BUILD_FOLDER EXECUTABLE_NAME "_bench");
 
-    if (!nob_cmd_run(&cmd)) return 1;
+        if (!nob_cmd_run(&cmd)) return 1;
+    }
 
     return 0;
 }
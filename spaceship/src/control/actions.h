@@ -30,55 +30,40 @@ typedef enum Action {
 // ---- Defaults --------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-InputMap default_kbm_maps[ACTION_TYPES_COUNT] = {
-    MAP_KEYBOARD_KEY_PRESSED(KEY_P), /* ACTION_PAUSE */
-
-    MAP_KEYBOARD_KEY_DOWN(KEY_W), /* ACTION_MOVE_UP */
-    MAP_KEYBOARD_KEY_DOWN(KEY_D), /* ACTION_MOVE_RIGHT */
-    MAP_KEYBOARD_KEY_DOWN(KEY_S), /* ACTION_MOVE_DOWN */
-    MAP_KEYBOARD_KEY_DOWN(KEY_A), /* ACTION_MOVE_LEFT */
-
-    MAP_MOUSE_POSITION(MOUSE_AXIS_X), /* ACTION_AIM_X */
-    MAP_MOUSE_POSITION(MOUSE_AXIS_Y), /* ACTION_AIM_Y */
-
-    MAP_MOUSE_BUTTON_DOWN(MOUSE_BUTTON_LEFT),  /* ACTION_ABILITY_SHOOT */
-    MAP_MOUSE_BUTTON_DOWN(MOUSE_BUTTON_RIGHT), /* ACTION_ABILITY_MISSILE */
-    MAP_KEYBOARD_KEY_DOWN(KEY_SPACE),          /* ACTION_ABILITY_DASH */
-};
-
-InputMap default_gpd_maps[ACTION_TYPES_COUNT] = {
-    MAP_GAMEPAD_BUTTON_PRESSED(GAMEPAD_BUTTON_MIDDLE_RIGHT), /* ACTION_PAUSE */
-
-    MAP_KEYBOARD_KEY_DOWN(KEY_W), /* ACTION_MOVE_UP */
-    MAP_KEYBOARD_KEY_DOWN(KEY_D), /* ACTION_MOVE_RIGHT */
-    MAP_KEYBOARD_KEY_DOWN(KEY_S), /* ACTION_MOVE_DOWN */
-    MAP_KEYBOARD_KEY_DOWN(KEY_A), /* ACTION_MOVE_LEFT */
-
-    MAP_MOUSE_POSITION(MOUSE_AXIS_X), /* ACTION_AIM_X */
-    MAP_MOUSE_POSITION(MOUSE_AXIS_Y), /* ACTION_AIM_Y */
-
-    MAP_MOUSE_BUTTON_DOWN(MOUSE_BUTTON_LEFT),  /* ACTION_ABILITY_SHOOT */
-    MAP_MOUSE_BUTTON_DOWN(MOUSE_BUTTON_RIGHT), /* ACTION_ABILITY_MISSILE */
-    MAP_KEYBOARD_KEY_DOWN(KEY_SPACE),          /* ACTION_ABILITY_DASH */
-};
+// Initializer of the default keyboard and mouse mappings of every action
+#define ACTION_MAPPING_DEFAULT_KEYBOARD_AND_MOUSE                               \
+    {                                                                           \
+        MAP_KEYBOARD_KEY_PRESSED(KEY_P), /* ACTION_PAUSE */                     \
+                                                                                \
+        MAP_KEYBOARD_KEY_DOWN(KEY_W), /* ACTION_MOVE_UP */                      \
+        MAP_KEYBOARD_KEY_DOWN(KEY_D), /* ACTION_MOVE_RIGHT */                   \
+        MAP_KEYBOARD_KEY_DOWN(KEY_S), /* ACTION_MOVE_DOWN */                    \
+        MAP_KEYBOARD_KEY_DOWN(KEY_A), /* ACTION_MOVE_LEFT */                    \
+                                                                                \
+        MAP_MOUSE_POSITION(MOUSE_AXIS_X), /* ACTION_AIM_X */                    \
+        MAP_MOUSE_POSITION(MOUSE_AXIS_Y), /* ACTION_AIM_Y */                    \
+                                                                                \
+        MAP_MOUSE_BUTTON_DOWN(MOUSE_BUTTON_LEFT),  /* ACTION_ABILITY_SHOOT */   \
+        MAP_MOUSE_BUTTON_DOWN(MOUSE_BUTTON_RIGHT), /* ACTION_ABILITY_MISSILE */ \
+        MAP_KEYBOARD_KEY_DOWN(KEY_SPACE),          /* ACTION_ABILITY_DASH */    \
+    }
 
-#define ACTION_MAPPING_DEFAULT_GAMEPAD                                                             \
-    {                                                                                              \
-        {INPUT_METHOD_GAMEPAD_BUTTON, GAMEPAD_BUTTON_MIDDLE_RIGHT}, /* ACTION_PAUSE */             \
-                                                                                                   \
-        {INPUT_METHOD_GAMEPAD_JOYSTICK, GAMEPAD_JOYSTICK_LEFT_NEGATIVE_Y}, /* ACTION_MOVE_UP */    \
-        {INPUT_METHOD_GAMEPAD_JOYSTICK, GAMEPAD_JOYSTICK_LEFT_POSITIVE_X}, /* ACTION_MOVE_RIGHT */ \
-        {INPUT_METHOD_GAMEPAD_JOYSTICK, GAMEPAD_JOYSTICK_LEFT_POSITIVE_Y}, /* ACTION_MOVE_DOWN */  \
-        {INPUT_METHOD_GAMEPAD_JOYSTICK, GAMEPAD_JOYSTICK_LEFT_NEGATIVE_X}, /* ACTION_MOVE_LEFT */  \
-                                                                                                   \
-        {INPUT_METHOD_GAMEPAD_JOYSTICK, GAMEPAD_JOYSTICK_RIGHT_NEGATIVE_Y}, /* ACTION_AIM_UP */    \
-        {INPUT_METHOD_GAMEPAD_JOYSTICK, GAMEPAD_JOYSTICK_RIGHT_POSITIVE_X}, /* ACTION_AIM_RIGHT */ \
-        {INPUT_METHOD_GAMEPAD_JOYSTICK, GAMEPAD_JOYSTICK_RIGHT_POSITIVE_Y}, /* ACTION_AIM_DOWN */  \
-        {INPUT_METHOD_GAMEPAD_JOYSTICK, GAMEPAD_JOYSTICK_RIGHT_NEGATIVE_X}, /* ACTION_AIM_LEFT */  \
-                                                                                                   \
-        {INPUT_METHOD_GAMEPAD_TRIGGER, GAMEPAD_TRIGGER_RIGHT},        /* ACTION_ABILITY_SHOOT */   \
-        {INPUT_METHOD_GAMEPAD_TRIGGER, GAMEPAD_TRIGGER_LEFT},         /* ACTION_ABILITY_MISSILE */ \
-        {INPUT_METHOD_GAMEPAD_BUTTON, GAMEPAD_BUTTON_LEFT_TRIGGER_1}, /* ACTION_ABILITY_DASH */    \
+// Initializer of the default gamepad mappings of every action
+#define ACTION_MAPPING_DEFAULT_GAMEPAD                                                              \
+    {                                                                                               \
+        MAP_GAMEPAD_BUTTON_PRESSED(GAMEPAD_BUTTON_MIDDLE_RIGHT), /* ACTION_PAUSE */                 \
+                                                                                                    \
+        MAP_GAMEPAD_JOYSTICK(GAMEPAD_JOYSTICK_LEFT_Y, AXIS_RANGE_NEGATIVE), /* ACTION_MOVE_UP */    \
+        MAP_GAMEPAD_JOYSTICK(GAMEPAD_JOYSTICK_LEFT_X, AXIS_RANGE_POSITIVE), /* ACTION_MOVE_RIGHT */ \
+        MAP_GAMEPAD_JOYSTICK(GAMEPAD_JOYSTICK_LEFT_Y, AXIS_RANGE_POSITIVE), /* ACTION_MOVE_DOWN */  \
+        MAP_GAMEPAD_JOYSTICK(GAMEPAD_JOYSTICK_LEFT_X, AXIS_RANGE_NEGATIVE), /* ACTION_MOVE_LEFT */  \
+                                                                                                    \
+        MAP_GAMEPAD_JOYSTICK(GAMEPAD_JOYSTICK_RIGHT_X, AXIS_RANGE_ALL), /* ACTION_AIM_X */          \
+        MAP_GAMEPAD_JOYSTICK(GAMEPAD_JOYSTICK_RIGHT_Y, AXIS_RANGE_ALL), /* ACTION_AIM_Y */          \
+                                                                                                    \
+        MAP_GAMEPAD_TRIGGER_NORM(GAMEPAD_TRIGGER_RIGHT),       /* ACTION_ABILITY_SHOOT */         \
+        MAP_GAMEPAD_TRIGGER_NORM(GAMEPAD_TRIGGER_LEFT),        /* ACTION_ABILITY_MISSILE */       \
+        MAP_GAMEPAD_BUTTON_DOWN(GAMEPAD_BUTTON_LEFT_TRIGGER_1), /* ACTION_ABILITY_DASH */          \
     }
 
 #endif  // __ACTIONS_H__
\ No newline at end of file
@@ -10,8 +10,11 @@
 #include "types/types.h"
 
 DebugPanel* DebugPanelCreate(Color background_color, Font font) {
-    DebugPanel* panel = reserve(DebugPanel);
-    *panel = (DebugPanel){.arena = ArenaCreate(), .background_color = background_color, .font = font, .titles = 0, .entries = 0, .content_size = {0}};
+    DebugPanel* panel = reserve_t(DebugPanel);
+    *panel = (DebugPanel){.arena = ArenaCreate(),
+                          .first_record = NULL,
+                          .last_record = NULL,
+                          .background_color = background_color, .font = font, .titles = 0, .entries = 0, .content_size = {0}};
     return panel;
 }
 
@@ -20,40 +23,36 @@ void DebugPanelDelete(DebugPanel* panel) {
     free(panel);
 }
 
-void DebugPanelAddTitle(DebugPanel* panel, const char* title) {
-    ++panel->titles;
+// Appends a record to the end of the panel
+void _DebugPanelRecordAdd(DebugPanel* panel, const char* text, bool is_title, f32 font_size) {
+    usize text_size = TextLength(text) + 1;
 
-    usize title_size = TextLength(title) + 1;
+    DebugPanelRecord* record = ArenaPushZeroAligned(&panel->arena, sizeof(DebugPanelRecord) + sizeof(char) * text_size, _Alignof(DebugPanelRecord));
+    record->is_title = is_title;
 
-    *ArenaPushType(&panel->arena, bool) = true;             // Is a title
-    *ArenaPushTypeZero(&panel->arena, usize) = title_size;  // Text size
-    f32* height = ArenaPushTypeZero(&panel->arena, f32);
-    char* title_mem = ArenaPushArrayZero(&panel->arena, char, title_size);
+    if (text != NULL) {
+        memory_copy(record->text, text, text_size - 1);
+        Vector2 text_measures = MeasureTextEx(panel->font, text, font_size, DEBUG_PANEL_FONT_SPACING);
+        panel->content_size.x = max(panel->content_size.x, text_measures.x);
+        panel->content_size.y += record->height = text_measures.y;
+    }
 
-    if (title != NULL) {
-        memory_copy(title_mem, title, title_size - 1);
-        Vector2 title_measures = MeasureTextEx(panel->font, title, DEBUG_PANEL_TITLE_FONT_SIZE, DEBUG_PANEL_FONT_SPACING);
-        panel->content_size.x = max(panel->content_size.x, title_measures.x);
-        panel->content_size.y += * height = title_measures.y;
+    if (panel->last_record != NULL) {
+        panel->last_record->next = record;
+    } else {
+        panel->first_record = record;
     }
+    panel->last_record = record;
+}
+
+void DebugPanelAddTitle(DebugPanel* panel, const char* title) {
+    ++panel->titles;
+    _DebugPanelRecordAdd(panel, title, true, DEBUG_PANEL_TITLE_FONT_SIZE);
 }
 
 void DebugPanelAddEntry(DebugPanel* panel, const char* text) {
     ++panel->entries;
-
-    usize text_size = TextLength(text) + 1;
-
-    *ArenaPushType(&panel->arena, bool) = false;           // Is an entry
-    *ArenaPushTypeZero(&panel->arena, usize) = text_size;  // Text size
-    f32* height = ArenaPushTypeZero(&panel->arena, f32);
-    char* text_mem = ArenaPushArrayZero(&panel->arena, char, text_size);
-
-    if (text != NULL) {
-        memory_copy(text_mem, text, text_size - 1);
-        Vector2 text_measures = MeasureTextEx(panel->font, text, DEBUG_PANEL_ENTRY_FONT_SIZE, DEBUG_PANEL_FONT_SPACING);
-        panel->content_size.x = max(panel->content_size.x, text_measures.x);
-        panel->content_size.y += * height = text_measures.y;
-    }
+    _DebugPanelRecordAdd(panel, text, false, DEBUG_PANEL_ENTRY_FONT_SIZE);
 }
 
 void _DebugPanelTextDraw(const char* text, f32 x, f32 y, float font_size, Font font) { DrawTextEx(font, text, (Vector2){x, y}, font_size, 0, WHITE); }
@@ -77,35 +76,17 @@ void DebugPanelDraw(DebugPanel panel, Vector2 screen_position) {
     x += DEBUG_PANEL_PADDING_X + DEBUG_PANEL_BORDER_SIZE;
     y += DEBUG_PANEL_PADDING_Y + DEBUG_PANEL_BORDER_SIZE;
 
-    u32 remaining_titles = panel.titles;
-    u32 remaining_entries = panel.entries;
-    uptr ptr = (uptr)panel.arena.memory;
-
-    while (remaining_titles > 0 || remaining_entries > 0) {
-        bool is_title = *(bool*)ptr;
-
-        ptr += sizeof(bool);
-        usize size = *(usize*)ptr;
-        ptr += sizeof(usize);
-
-        f32 height = *(f32*)ptr;
-        ptr += sizeof(f32);
-
-        char* text = (char*)ptr;
-        ptr += sizeof(char) * size;
-
+    for (DebugPanelRecord* record = panel.first_record; record != NULL; record = record->next) {
         f32 font_size;
-        if (is_title) {
+        if (record->is_title) {
             font_size = DEBUG_PANEL_TITLE_FONT_SIZE;
             y += DEBUG_PANEL_TITLE_SPACING;
-            --remaining_titles;
         } else {
             font_size = DEBUG_PANEL_ENTRY_FONT_SIZE;
-            --remaining_entries;
         }
-        _DebugPanelTextDraw(text, x, y, font_size, panel.font);
+        _DebugPanelTextDraw(record->text, x, y, font_size, panel.font);
 
-        y += height;
+        y += record->height;
     }
 }
 
@@ -113,6 +94,8 @@ void DebugPanelClean(DebugPanel* panel) {
     panel->titles = 0;
     panel->entries = 0;
     panel->content_size = Vector2Zero();
+    panel->first_record = NULL;
+    panel->last_record = NULL;
     ArenaClear(&panel->arena);
 }
 
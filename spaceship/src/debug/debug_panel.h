@@ -8,8 +8,20 @@
 #include "raylib/raylib.h"
 #include "types/types.h"
 
+/**
+ * Title or entry of a debug panel, followed by its text.
+ */
+typedef struct DebugPanelRecord {
+    struct DebugPanelRecord* next;
+    f32 height;
+    bool is_title;
+    char text[];
+} DebugPanelRecord;
+
 typedef struct DebugPanel {
     Arena arena;
+    DebugPanelRecord* first_record;
+    DebugPanelRecord* last_record;
     Color background_color;
     Font font;
     u32 titles;
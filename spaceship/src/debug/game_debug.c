@@ -2,32 +2,71 @@
 
 #include "debug/game_debug.h"
 #include "debug/debug_panel.h"
+#include "utils/extra_math.h"
 #include "lifecycles/game_state.h"
 
 DebugPanel* timings_panel;
 DebugPanel* entities_panel;
 DebugPanel* inputs_panel;
+DebugPanel* pools_panel;
 
 // Debug panels initialization
 void GameDebugInitialize(void) {
     timings_panel = DebugPanelCreate(DARKGREEN, state->font);
     entities_panel = DebugPanelCreate(GREEN, state->font);
     inputs_panel = DebugPanelCreate(ORANGE, state->font);
+    pools_panel = DebugPanelCreate(SKYBLUE, state->font);
 }
 
 // Debug input check
 void GameDebugInput(void) { /* Empty for now */ }
 
+// Usage counters of the archetype of a mix of components
+void _GameDebugArchetypeEntries(const char* title, EcsComponentMask mask) {
+    EcsArchetype* archetype = EcsArchetypeFind(&state->world, mask);
+
+    DebugPanelAddTitle(pools_panel, title);
+    if (archetype == NULL) {
+        DebugPanelAddEntry(pools_panel, "Count: 0 / 0");
+        return;
+    }
+
+    EcsArchetypeStats stats = archetype->stats;
+    DebugPanelAddEntry(pools_panel, TextFormat("Count: %u / %u (peak %u)", archetype->count, archetype->capacity, stats.peak_count));
+    DebugPanelAddEntry(pools_panel, TextFormat("Churn: +%u -%u per frame", stats.frame_adds, stats.frame_removes));
+    DebugPanelAddEntry(pools_panel,
+                       TextFormat("Memory: %.1f / %.1f KiB", EcsArchetypeBytesUsed(&state->world, archetype) / 1024.0,
+                                  EcsArchetypeBytesReserved(&state->world, archetype) / 1024.0));
+    DebugPanelAddEntry(pools_panel,
+                       TextFormat("Grows: %u (last %.3f ms, max %.3f ms)", stats.grow_count, stats.grow_time_last * 1000, stats.grow_time_max * 1000));
+}
+
+// Name of a layout of the collisions stress scenario
+const char* _GameDebugStressLayoutName(TestingStressLayout layout) {
+    switch (layout) {
+        case TESTING_STRESS_LAYOUT_UNIFORM: return "uniform";
+        case TESTING_STRESS_LAYOUT_CLUSTERED: return "clustered";
+        case TESTING_STRESS_LAYOUT_LINE: return "line";
+        default: return "unknown";
+    }
+}
+
 // Debug update
 void GameDebugUpdate(void) {
     DebugPanelClean(timings_panel);
     DebugPanelClean(entities_panel);
     DebugPanelClean(inputs_panel);
+    DebugPanelClean(pools_panel);
 
     DebugPanelAddTitle(timings_panel, "TIMINGS");
     DebugPanelAddEntry(timings_panel, TextFormat("%d fps", GetFPS()));
+    DebugPanelAddEntry(timings_panel, TextFormat("%u ticks this frame (%d Hz)", state->time_frame_ticks, GAME_STATE_TICK_RATE));
     DebugPanelAddEntry(timings_panel, TextFormat("%d%% speed", 100 + 20 * state->time_speed_magnitude));
     DebugPanelAddEntry(timings_panel, TextFormat("Game %s", state->time_running ? "running" : "paused"));
+    DebugPanelAddEntry(timings_panel, TextFormat("Broadphase: %s", CollisionBroadphaseName(state->collision_world.broadphase)));
+    for (GameStage stage = 0; stage < GAME_STAGE_COUNT; ++stage) {
+        DebugPanelAddEntry(timings_panel, TextFormat("%s: %.3f ms", GameStageName(stage), state->stage_times[stage] * 1000));
+    }
 
     ForEachPlayerVal(iter) {
         DebugPanelAddTitle(entities_panel, TextFormat("PLAYER %d", iter.index));
@@ -37,22 +76,16 @@ void GameDebugUpdate(void) {
         DebugPanelAddEntry(entities_panel, TextFormat("Velocity: (%.2f, %.2f)", velocity.x, velocity.y));
     }
 
-    DebugPanelAddTitle(entities_panel, "PLAYER PROYECTILES");
-    DebugPanelAddEntry(entities_panel, TextFormat("Chunks: %u", ObjectPoolChunkCount(state->projectiles_players)));
-    DebugPanelAddEntry(entities_panel, TextFormat("Valid: %u", ObjectPoolObjectCount(state->projectiles_players)));
-
-    DebugPanelAddTitle(entities_panel, "ENEMIES");
-    DebugPanelAddEntry(entities_panel, TextFormat("Chunks: %u", ObjectPoolChunkCount(state->enemies)));
-    DebugPanelAddEntry(entities_panel, TextFormat("Valid: %u", ObjectPoolObjectCount(state->enemies)));
-
-    DebugPanelAddTitle(entities_panel, "ENEMY PROYECTILES");
-    DebugPanelAddEntry(entities_panel, TextFormat("Chunks: %u", ObjectPoolChunkCount(state->projectiles_enemies)));
-    DebugPanelAddEntry(entities_panel, TextFormat("Valid: %u", ObjectPoolObjectCount(state->projectiles_enemies)));
+    _GameDebugArchetypeEntries("ENEMIES", ARCHETYPE_ENEMY);
+    _GameDebugArchetypeEntries("PROYECTILES", ARCHETYPE_PROJECTILE);
 
     DebugPanelAddTitle(inputs_panel, "TESTING INPUTS");
     DebugPanelAddEntry(inputs_panel, "1 >> Generate enemies around player");
     DebugPanelAddEntry(inputs_panel, "2 >> Show/Hide bounding boxes");
     DebugPanelAddEntry(inputs_panel, "3 >> Show/Hide player rotation lines");
+    DebugPanelAddEntry(inputs_panel, "4 >> Switch collision broadphase");
+    DebugPanelAddEntry(inputs_panel, TextFormat("5 >> Generate collisions stress test (%s)", _GameDebugStressLayoutName(state->testing_stress_layout)));
+    DebugPanelAddEntry(inputs_panel, "6 >> Switch collisions stress test layout");
     DebugPanelAddEntry(inputs_panel, "7 >> Maximize window");
     DebugPanelAddEntry(inputs_panel, "8 >> Toggle borderless window");
     DebugPanelAddEntry(inputs_panel, "9 >> Toggle fullscreen window");
@@ -61,11 +94,21 @@ void GameDebugUpdate(void) {
     DebugPanelAddEntry(inputs_panel, "Page Down >> Decrease game speed");
 }
 
-// Debug draw
+// Debug draw. Panels are laid out from the size of the previous ones, as their rows change every frame:
+// timings, entities and inputs stacked on a column, and the pools to its right
 void GameDebugDraw(void) {
-    DebugPanelDraw(*timings_panel, DEBUG_PANEL_TIMINGS_POSITION);
-    DebugPanelDraw(*entities_panel, DEBUG_PANEL_ENTITIES_POSITION);
-    DebugPanelDraw(*inputs_panel, DEBUG_PANEL_INPUTS_POSITION);
+    DebugPanel* column[] = {timings_panel, entities_panel, inputs_panel};
+
+    Vector2 position = DEBUG_PANELS_POSITION;
+    f32 column_width = 0;
+    for (u32 i = 0; i < sizeof(column) / sizeof(DebugPanel*); ++i) {
+        Vector2 measures = DebugPanelMeasures(*column[i]);
+        DebugPanelDraw(*column[i], position);
+        position.y += measures.y + DEBUG_PANELS_SEPARATION;
+        column_width = max(column_width, measures.x);
+    }
+
+    DebugPanelDraw(*pools_panel, (Vector2){DEBUG_PANELS_POSITION.x + column_width + DEBUG_PANELS_SEPARATION, DEBUG_PANELS_POSITION.y});
 }
 
 // Debug clear
@@ -73,6 +116,7 @@ void GameDebugClear(void) {
     DebugPanelDelete(timings_panel);
     DebugPanelDelete(entities_panel);
     DebugPanelDelete(inputs_panel);
+    DebugPanelDelete(pools_panel);
 }
 
 #endif  // DEBUG
@@ -6,13 +6,13 @@
 
 #include "debug/debug_panel.h"
 
-#define DEBUG_PANEL_TIMINGS_POSITION  ((Vector2){20, 20})
-#define DEBUG_PANEL_ENTITIES_POSITION ((Vector2){20, 100})
-#define DEBUG_PANEL_INPUTS_POSITION   ((Vector2){20, 330})
+#define DEBUG_PANELS_POSITION   ((Vector2){20, 20})  // Top-left corner of the first panel
+#define DEBUG_PANELS_SEPARATION 10                   // Gap between the panels
 
 extern DebugPanel* timings_panel;
 extern DebugPanel* entities_panel;
 extern DebugPanel* inputs_panel;
+extern DebugPanel* pools_panel;
 
 /**
  * Debug panels initialization
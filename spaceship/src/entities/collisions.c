@@ -1,7 +1,598 @@
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
 #include "entities/collisions.h"
 #include "entities/entities.h"
+#include "utils/memory_utils.h"
 #include "raylib/raymath.h"
 
 bool CheckEntityCollision(Entity e1, Entity e2) {
-    return Vector2Distance(EntityBoundingCircleCenter(e1), EntityBoundingCircleCenter(e2)) <= (e1.bounding_circle.radius + e2.bounding_circle.radius);
-}
\ No newline at end of file
+    f32 radiuses_sum = e1.bounding_circle.radius + e2.bounding_circle.radius;
+    return Vector2DistanceSqr(EntityBoundingCircleCenter(e1), EntityBoundingCircleCenter(e2)) <= radiuses_sum * radiuses_sum;
+}
+
+// ----------------------------------------------------------------------------
+// ---- Collision circles -----------------------------------------------------
+// ----------------------------------------------------------------------------
+
+CollisionCircles CollisionCirclesCreate(Arena* arena, u32 capacity, u32 id_limit) {
+    return (CollisionCircles){.x = ArenaPushArray(arena, f32, capacity),
+                              .y = ArenaPushArray(arena, f32, capacity),
+                              .radius = ArenaPushArray(arena, f32, capacity),
+                              .body_radius = ArenaPushArray(arena, f32, capacity),
+                              .motion_x = ArenaPushArray(arena, f32, capacity),
+                              .motion_y = ArenaPushArray(arena, f32, capacity),
+                              .ids = ArenaPushArray(arena, u32, capacity),
+                              .layers = ArenaPushArray(arena, u8, capacity),
+                              .masks = ArenaPushArray(arena, u16, capacity),
+                              .count = 0,
+                              .capacity = capacity,
+                              .id_limit = id_limit,
+                              .max_radius = 0,
+                              .moving_count = 0};
+}
+
+u32 CollisionCirclesAdd(CollisionCircles* circles, Vector2 center, f32 radius, u32 id, u8 layer, u16 mask) {
+    return CollisionCirclesAddSwept(circles, center, center, radius, id, layer, mask);
+}
+
+u32 CollisionCirclesAddSwept(CollisionCircles* circles, Vector2 start, Vector2 end, f32 radius, u32 id, u8 layer, u16 mask) {
+    u32 i = circles->count++;
+    f32 motion_x = end.x - start.x, motion_y = end.y - start.y;
+
+    // Circle covering the whole motion
+    circles->x[i] = start.x + motion_x * 0.5f;
+    circles->y[i] = start.y + motion_y * 0.5f;
+    circles->radius[i] = radius + sqrtf(motion_x * motion_x + motion_y * motion_y) * 0.5f;
+
+    circles->body_radius[i] = radius;
+    circles->motion_x[i] = motion_x;
+    circles->motion_y[i] = motion_y;
+    circles->ids[i] = id;
+    circles->layers[i] = layer;
+    circles->masks[i] = mask;
+    circles->max_radius = max(circles->max_radius, circles->radius[i]);
+    circles->moving_count += motion_x != 0 || motion_y != 0;
+    return i;
+}
+
+Vector2 CollisionCirclesEnd(CollisionCircles circles, u32 index) {
+    return (Vector2){circles.x[index] + circles.motion_x[index] * 0.5f, circles.y[index] + circles.motion_y[index] * 0.5f};
+}
+
+void _CollisionPairsAdd(CollisionPairs* pairs, u32 a, u32 b) {
+    if (pairs->count == pairs->capacity) {
+        pairs->capacity = max(pairs->capacity * 2, 256);
+        pairs->pairs = (CollisionPair*)realloc(pairs->pairs, sizeof(CollisionPair) * pairs->capacity);
+    }
+    pairs->pairs[pairs->count++] = (CollisionPair){.a = a, .b = b};
+}
+
+void CollisionPairsDelete(CollisionPairs* pairs) {
+    for (u32 c = 0; c < pairs->chunk_capacity; ++c) { free(pairs->chunks[c].pairs); }
+    free(pairs->chunks);
+    free(pairs->pairs);
+    free(pairs->sweep.keys);
+    free(pairs->sweep.slots);
+    *pairs = (CollisionPairs){0};
+}
+
+// Circles overlap when the distance between centers is not greater than the sum of radiuses
+#define _CollisionCirclesOverlap(a, i, b, j)                                                            \
+    ((((a).x[i] - (b).x[j]) * ((a).x[i] - (b).x[j]) + ((a).y[i] - (b).y[j]) * ((a).y[i] - (b).y[j])) <= \
+     (((a).radius[i] + (b).radius[j]) * ((a).radius[i] + (b).radius[j])))
+
+// Circles can collide when the mask of each one has the layer of the other
+#define _CollisionCirclesMatch(circles, i, j) \
+    ((((circles).masks[i] >> (circles).layers[j]) & ((circles).masks[j] >> (circles).layers[i]) & 1) != 0)
+
+u64 CollisionCircleOverlapMask(f32 x, f32 y, f32 radius, const f32* xs, const f32* ys, const f32* radiuses, u32 count) {
+    u64 mask = 0;
+    u32 k = 0;
+
+#if defined(__AVX__)
+    __m256 x8 = _mm256_set1_ps(x), y8 = _mm256_set1_ps(y), radius8 = _mm256_set1_ps(radius);
+    for (; k + 8 <= count; k += 8) {
+        __m256 dx = _mm256_sub_ps(x8, _mm256_loadu_ps(xs + k)), dy = _mm256_sub_ps(y8, _mm256_loadu_ps(ys + k));
+        __m256 radiuses_sum = _mm256_add_ps(radius8, _mm256_loadu_ps(radiuses + k));
+        __m256 distance_sq = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+        __m256 hits = _mm256_cmp_ps(distance_sq, _mm256_mul_ps(radiuses_sum, radiuses_sum), _CMP_LE_OQ);
+        mask |= (u64)(u32)_mm256_movemask_ps(hits) << k;
+    }
+#elif defined(__SSE__)
+    __m128 x4 = _mm_set1_ps(x), y4 = _mm_set1_ps(y), radius4 = _mm_set1_ps(radius);
+    for (; k + 4 <= count; k += 4) {
+        __m128 dx = _mm_sub_ps(x4, _mm_loadu_ps(xs + k)), dy = _mm_sub_ps(y4, _mm_loadu_ps(ys + k));
+        __m128 radiuses_sum = _mm_add_ps(radius4, _mm_loadu_ps(radiuses + k));
+        __m128 distance_sq = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        __m128 hits = _mm_cmple_ps(distance_sq, _mm_mul_ps(radiuses_sum, radiuses_sum));
+        mask |= (u64)(u32)_mm_movemask_ps(hits) << k;
+    }
+#endif
+
+    for (; k < count; ++k) {
+        f32 dx = x - xs[k], dy = y - ys[k], radiuses_sum = radius + radiuses[k];
+        f32 distance_sq = dx * dx + dy * dy;
+        mask |= (u64)(distance_sq <= radiuses_sum * radiuses_sum) << k;
+    }
+    return mask;
+}
+
+// Tests a circle against consecutive circles of a copy of its group, reordered so the candidates are contiguous.
+// Circles of its own layer are only paired if they come later on the group, so every pair is found once.
+// `items` maps the position on the copy to the circle index on the group, or is null if they match.
+void _CollisionBatchTest(CollisionCircles circles, u32 i, CollisionCircles copy, const u32* items, u32 first, u32 last, CollisionPairs* pairs) {
+    u8 layer = circles.layers[i];
+    u16 mask = circles.masks[i];
+
+    for (u32 batch = first; batch < last; batch += COLLISION_BATCH_SIZE) {
+        u32 count = min(last - batch, COLLISION_BATCH_SIZE);
+        for (u64 hits = CollisionCircleOverlapMask(circles.x[i], circles.y[i], circles.radius[i], copy.x + batch, copy.y + batch, copy.radius + batch, count);
+             hits; hits &= hits - 1) {
+            u32 k = batch + (u32)__builtin_ctzll(hits);
+            if (((mask >> copy.layers[k]) & (copy.masks[k] >> layer) & 1) == 0) { continue; }
+
+            u32 j = items != NULL ? items[k] : k;
+            if (j > i || copy.layers[k] != layer) { _CollisionPairsAdd(pairs, min(i, j), max(i, j)); }
+        }
+    }
+}
+
+// Counting sort of the circles by their layer. Fills the first circle of each layer, followed by the number of circles
+u32* _CollisionLayersSplit(CollisionCircles circles, u32 layer_starts[COLLISION_MAX_LAYERS + 1], Arena* arena) {
+    u32* items = ArenaPushArray(arena, u32, circles.count);
+
+    memory_zero(layer_starts, sizeof(u32) * (COLLISION_MAX_LAYERS + 1));
+    for (u32 i = 0; i < circles.count; ++i) { ++layer_starts[circles.layers[i] + 1]; }
+    for (u32 l = 1; l <= COLLISION_MAX_LAYERS; ++l) { layer_starts[l] += layer_starts[l - 1]; }
+
+    u32 layer_ends[COLLISION_MAX_LAYERS];
+    memory_copy(layer_ends, layer_starts, sizeof(layer_ends));
+    for (u32 i = 0; i < circles.count; ++i) { items[layer_ends[circles.layers[i]]++] = i; }
+
+    return items;
+}
+
+// Two circles moving in straight lines overlap at some point of the step when their closest approach is not greater than
+// the sum of radiuses. Still circles are fully tested by the broadphase.
+bool _CollisionSweptOverlap(CollisionCircles circles, u32 i, u32 j) {
+    bool still_i = circles.motion_x[i] == 0 && circles.motion_y[i] == 0, still_j = circles.motion_x[j] == 0 && circles.motion_y[j] == 0;
+    if (still_i && still_j) { return true; }
+
+    f32 motion_x = circles.motion_x[i] - circles.motion_x[j], motion_y = circles.motion_y[i] - circles.motion_y[j];
+
+    // Position of the first circle relative to the second one, at the start of the step
+    f32 start_x = (circles.x[i] - circles.x[j]) - motion_x * 0.5f, start_y = (circles.y[i] - circles.y[j]) - motion_y * 0.5f;
+    f32 motion_sq = motion_x * motion_x + motion_y * motion_y;
+    f32 t = motion_sq > 0 ? Clamp(-(start_x * motion_x + start_y * motion_y) / motion_sq, 0, 1) : 0;
+
+    f32 dx = start_x + motion_x * t, dy = start_y + motion_y * t, radiuses_sum = circles.body_radius[i] + circles.body_radius[j];
+    return dx * dx + dy * dy <= radiuses_sum * radiuses_sum;
+}
+
+// Drops the pairs whose circles only overlap on the area covered by their motion
+void _CollisionSweptFilter(CollisionCircles circles, CollisionPairs* pairs) {
+    u32 kept = 0;
+    for (u32 p = 0; p < pairs->count; ++p) {
+        if (_CollisionSweptOverlap(circles, pairs->pairs[p].a, pairs->pairs[p].b)) { pairs->pairs[kept++] = pairs->pairs[p]; }
+    }
+    pairs->count = kept;
+}
+
+// ----------------------------------------------------------------------------
+// ---- Parallel search -------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+// Finds the pairs of a circle with the structures of a broadphase
+typedef void (*CollisionCircleSearch)(const void* broadphase, CollisionCircles circles, u32 i, CollisionPairs* pairs);
+
+typedef struct CollisionSearchJob {
+    CollisionCircles circles;
+    CollisionCircleSearch search;
+    const void* broadphase;  // Structures of the broadphase, read only during the search
+    CollisionPairs* chunks;  // Pairs of every job
+} CollisionSearchJob;
+
+// Pairs of a range of circles, confirmed along the motion of the circles before they are merged
+void _CollisionSearchChunk(void* data, u32 first, u32 last) {
+    CollisionSearchJob* job = (CollisionSearchJob*)data;
+    CollisionPairs* pairs = &job->chunks[JobChunkIndex(first, COLLISION_JOB_CIRCLES)];
+
+    pairs->count = 0;
+    for (u32 i = first; i < last; ++i) { job->search(job->broadphase, job->circles, i, pairs); }
+
+    if (job->circles.moving_count > 0) { _CollisionSweptFilter(job->circles, pairs); }
+}
+
+// Splits the search by circle. Every job stores its pairs apart and they are merged in circle order,
+// so the pairs come in the same order no matter which worker ran each job
+void _CollisionSearch(CollisionCircles circles, CollisionCircleSearch search, const void* broadphase, CollisionPairs* pairs, JobSystem* jobs) {
+    u32 chunk_count = JobChunkCount(circles.count, COLLISION_JOB_CIRCLES);
+    if (pairs->chunk_capacity < chunk_count) {
+        u32 capacity = max(chunk_count, pairs->chunk_capacity * 2);
+        pairs->chunks = (CollisionPairs*)realloc(pairs->chunks, sizeof(CollisionPairs) * capacity);
+        memory_zero(pairs->chunks + pairs->chunk_capacity, sizeof(CollisionPairs) * (capacity - pairs->chunk_capacity));
+        pairs->chunk_capacity = capacity;
+    }
+
+    CollisionSearchJob job = {.circles = circles, .search = search, .broadphase = broadphase, .chunks = pairs->chunks};
+    JobCounter counter = {0};
+    JobSystemParallelFor(jobs, circles.count, COLLISION_JOB_CIRCLES, _CollisionSearchChunk, &job, &counter);
+    JobSystemWait(jobs, &counter);
+
+    u32 count = 0;
+    for (u32 c = 0; c < chunk_count; ++c) { count += pairs->chunks[c].count; }
+    if (pairs->capacity < count) {
+        pairs->capacity = max(count, pairs->capacity * 2);
+        pairs->pairs = (CollisionPair*)realloc(pairs->pairs, sizeof(CollisionPair) * pairs->capacity);
+    }
+    for (u32 c = 0; c < chunk_count; ++c) {
+        CollisionPairs* chunk = &pairs->chunks[c];
+        if (chunk->count > 0) { memory_copy(pairs->pairs + pairs->count, chunk->pairs, sizeof(CollisionPair) * chunk->count); }
+        pairs->count += chunk->count;
+    }
+}
+
+void _CollisionBruteForceSearch(const void* broadphase, CollisionCircles circles, u32 i, CollisionPairs* pairs) {
+    (void)broadphase;
+    if (circles.masks[i] != 0) { _CollisionBatchTest(circles, i, circles, NULL, i + 1, circles.count, pairs); }
+}
+
+void _CollisionBruteForce(CollisionCircles circles, CollisionPairs* pairs, JobSystem* jobs) {
+    _CollisionSearch(circles, _CollisionBruteForceSearch, NULL, pairs, jobs);
+}
+
+// ----------------------------------------------------------------------------
+// ---- Uniform grid ----------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+/**
+ * Uniform grid fitted to the bounds of the circles of a layer. Each circle is stored only on the cell of its center,
+ * so queries widen their range by the biggest radius and every pair is found once.
+ */
+typedef struct CollisionGrid {
+    f32 min_x;
+    f32 min_y;
+    f32 max_x;
+    f32 max_y;
+    f32 inverse_cell_size;
+    u32 columns;
+    u32 rows;
+    u32* cell_starts;  // First item of each cell, followed by the number of items
+    u32* items;             // Circle indices ordered by cell
+    CollisionCircles cells;  // Circles copied in cell order
+} CollisionGrid;
+
+u32 _CollisionGridCell(CollisionGrid* grid, f32 x, f32 y) {
+    u32 column = (u32)((x - grid->min_x) * grid->inverse_cell_size);
+    u32 row = (u32)((y - grid->min_y) * grid->inverse_cell_size);
+    return min(row, grid->rows - 1) * grid->columns + min(column, grid->columns - 1);
+}
+
+// Counting sort of some circles of a group by the cell of their center
+CollisionGrid _CollisionGridBuild(CollisionCircles circles, const u32* indices, u32 count, Arena* arena) {
+    f32 min_x = circles.x[indices[0]], max_x = min_x, min_y = circles.y[indices[0]], max_y = min_y, max_radius = 0;
+    for (u32 k = 0; k < count; ++k) {
+        u32 i = indices[k];
+        min_x = min(min_x, circles.x[i]);
+        max_x = max(max_x, circles.x[i]);
+        min_y = min(min_y, circles.y[i]);
+        max_y = max(max_y, circles.y[i]);
+        max_radius = max(max_radius, circles.radius[i]);
+    }
+
+    f32 cell_size = max(2 * circles.max_radius, COLLISION_GRID_MIN_CELL_SIZE);  // Fits the circles of any layer querying it
+    f32 max_cells = (f32)count * COLLISION_GRID_CELLS_PER_CIRCLE;
+    f32 area_cells = ((max_x - min_x) / cell_size + 1) * ((max_y - min_y) / cell_size + 1);
+    if (area_cells > max_cells) { cell_size *= sqrtf(area_cells / max_cells); }
+
+    CollisionGrid grid = {.min_x = min_x,
+                          .min_y = min_y,
+                          .max_x = max_x,
+                          .max_y = max_y,
+                          .inverse_cell_size = 1 / cell_size,
+                          .columns = (u32)((max_x - min_x) / cell_size) + 1,
+                          .rows = (u32)((max_y - min_y) / cell_size) + 1};
+
+    u32 cell_count = grid.columns * grid.rows;
+    grid.cell_starts = ArenaPushArrayZero(arena, u32, cell_count + 1);
+    grid.items = ArenaPushArray(arena, u32, count);
+    u32* circle_cells = ArenaPushArray(arena, u32, count);
+
+    for (u32 k = 0; k < count; ++k) {
+        circle_cells[k] = _CollisionGridCell(&grid, circles.x[indices[k]], circles.y[indices[k]]);
+        ++grid.cell_starts[circle_cells[k]];
+    }
+    for (u32 c = 1; c < cell_count; ++c) { grid.cell_starts[c] += grid.cell_starts[c - 1]; }  // Cell ends
+    grid.cell_starts[cell_count] = count;
+
+    for (u32 k = count; k-- > 0;) { grid.items[--grid.cell_starts[circle_cells[k]]] = indices[k]; }  // Ends become starts
+
+    // Circles copied in cell order, so the circles of a row of cells can be tested in batches
+    grid.cells = (CollisionCircles){.x = ArenaPushArrayCacheLine(arena, f32, count),
+                                    .y = ArenaPushArrayCacheLine(arena, f32, count),
+                                    .radius = ArenaPushArrayCacheLine(arena, f32, count),
+                                    .layers = ArenaPushArray(arena, u8, count),
+                                    .masks = ArenaPushArray(arena, u16, count),
+                                    .count = count,
+                                    .capacity = count,
+                                    .max_radius = max_radius};
+    for (u32 k = 0; k < count; ++k) {
+        u32 i = grid.items[k];
+        grid.cells.x[k] = circles.x[i];
+        grid.cells.y[k] = circles.y[i];
+        grid.cells.radius[k] = circles.radius[i];
+        grid.cells.layers[k] = circles.layers[i];
+        grid.cells.masks[k] = circles.masks[i];
+    }
+
+    return grid;
+}
+
+// Tests a circle against the circles of a grid
+void _CollisionGridQuery(const CollisionGrid* grid, CollisionCircles circles, u32 i, CollisionPairs* pairs) {
+    f32 range = circles.radius[i] + grid->cells.max_radius;
+    f32 x0 = circles.x[i] - range, x1 = circles.x[i] + range, y0 = circles.y[i] - range, y1 = circles.y[i] + range;
+    if (x1 < grid->min_x || y1 < grid->min_y || x0 > grid->max_x || y0 > grid->max_y) { return; }
+
+    u32 column_first = x0 <= grid->min_x ? 0 : (u32)((x0 - grid->min_x) * grid->inverse_cell_size);
+    u32 column_last = min((u32)((x1 - grid->min_x) * grid->inverse_cell_size), grid->columns - 1);
+    u32 row_first = y0 <= grid->min_y ? 0 : (u32)((y0 - grid->min_y) * grid->inverse_cell_size);
+    u32 row_last = min((u32)((y1 - grid->min_y) * grid->inverse_cell_size), grid->rows - 1);
+
+    for (u32 row = row_first; row <= row_last; ++row) {
+        u32 cell_first = row * grid->columns + column_first, cell_last = row * grid->columns + column_last;
+
+        // Cells of a row are contiguous, so their items are too
+        _CollisionBatchTest(circles, i, grid->cells, grid->items, grid->cell_starts[cell_first], grid->cell_starts[cell_last + 1], pairs);
+    }
+}
+
+// Mask of a layer and all the layers above it
+#define _CollisionLayersFrom(layer) ((u16)(0xFFFF << (layer)))
+
+typedef struct CollisionGrids {
+    CollisionGrid grids[COLLISION_MAX_LAYERS];
+    u16 layers;  // Layers with a grid
+} CollisionGrids;
+
+void _CollisionGridSearch(const void* broadphase, CollisionCircles circles, u32 i, CollisionPairs* pairs) {
+    const CollisionGrids* grids = (const CollisionGrids*)broadphase;
+    for (u32 layers = circles.masks[i] & grids->layers & _CollisionLayersFrom(circles.layers[i]); layers; layers &= layers - 1) {
+        _CollisionGridQuery(&grids->grids[__builtin_ctz(layers)], circles, i, pairs);
+    }
+}
+
+// One grid per layer, so circles are only tested against the layers of their mask.
+// Layers are queried only from their own layer or a lower one, so every pair is found once.
+void _CollisionGrid(CollisionCircles circles, CollisionPairs* pairs, JobSystem* jobs, Arena* scratch) {
+    u32 layer_starts[COLLISION_MAX_LAYERS + 1];
+    u32* layer_items = _CollisionLayersSplit(circles, layer_starts, scratch);
+
+    u16 queried_layers = 0;
+    for (u32 i = 0; i < circles.count; ++i) { queried_layers |= circles.masks[i] & _CollisionLayersFrom(circles.layers[i]); }
+
+    CollisionGrids grids = {.layers = 0};
+    for (u32 layers = queried_layers; layers; layers &= layers - 1) {
+        u32 layer = __builtin_ctz(layers), count = layer_starts[layer + 1] - layer_starts[layer];
+        if (count > 0) {
+            grids.grids[layer] = _CollisionGridBuild(circles, layer_items + layer_starts[layer], count, scratch);
+            grids.layers |= CollisionLayerBit(layer);
+        }
+    }
+
+    _CollisionSearch(circles, _CollisionGridSearch, &grids, pairs, jobs);
+}
+
+// ----------------------------------------------------------------------------
+// ---- Sweep and prune -------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+/**
+ * Extent of a circle on the x axis.
+ */
+typedef struct CollisionSweepItem {
+    f32 min_x;
+    f32 max_x;
+    u32 index;  // Index of the circle on its group
+} CollisionSweepItem;
+
+#define COLLISION_SWEEP_NO_SLOT UINT32_MAX
+
+// Key of a circle on the sweep order, lower than `id_limit * COLLISION_MAX_LAYERS`. Unique even for entities with a circle on several layers,
+// and for ids of different kinds, such as player indices and entity handles, as long as each kind has its own layers.
+// Generations are masked out: an entity reusing the record of one from the last sweep just starts from its place
+#define _CollisionSweepKey(circles, i) (((circles).ids[i] & COLLISION_ID_INDEX_MASK) * COLLISION_MAX_LAYERS + (circles).layers[i])
+
+int _CollisionSweepItemCompare(const void* a, const void* b) {
+    f32 min_a = ((const CollisionSweepItem*)a)->min_x, min_b = ((const CollisionSweepItem*)b)->min_x;
+    return (min_a > min_b) - (min_a < min_b);
+}
+
+// Sorts the extents of a group of circles, starting from the order of the last sweep.
+// Circles kept from the last sweep barely move between frames, so insertion sort runs close to linear time on them.
+// New circles are sorted on their own and merged.
+CollisionSweepItem* _CollisionSweepSort(CollisionCircles circles, CollisionSweepOrder* order, Arena* scratch) {
+    u32 key_count = circles.id_limit * COLLISION_MAX_LAYERS;
+    if (order->slot_capacity < key_count) {
+        u32 capacity = max(key_count, order->slot_capacity * 2);
+        order->slots = (u32*)realloc(order->slots, sizeof(u32) * capacity);
+        memory_fill(order->slots + order->slot_capacity, 0xFF, sizeof(u32) * (capacity - order->slot_capacity));
+        order->slot_capacity = capacity;
+    }
+    u32* slots = order->slots;
+    for (u32 i = 0; i < circles.count; ++i) {
+        assert(_CollisionSweepKey(circles, i) < key_count);
+        slots[_CollisionSweepKey(circles, i)] = i;
+    }
+
+    CollisionSweepItem* kept = ArenaPushArray(scratch, CollisionSweepItem, circles.count);
+    CollisionSweepItem* fresh = ArenaPushArray(scratch, CollisionSweepItem, circles.count);
+    bool* seeded = ArenaPushArrayZero(scratch, bool, circles.count);
+    u32 kept_count = 0, fresh_count = 0;
+
+    for (u32 k = 0; k < order->count; ++k) {
+        u32 key = order->keys[k];
+        if (key < key_count && slots[key] != COLLISION_SWEEP_NO_SLOT) {
+            u32 i = slots[key];
+            slots[key] = COLLISION_SWEEP_NO_SLOT;
+            seeded[i] = true;
+
+            CollisionSweepItem item = {.min_x = circles.x[i] - circles.radius[i], .max_x = circles.x[i] + circles.radius[i], .index = i};
+            u32 j = kept_count++;
+            for (; j > 0 && kept[j - 1].min_x > item.min_x; --j) { kept[j] = kept[j - 1]; }
+            kept[j] = item;
+        }
+    }
+    for (u32 i = 0; i < circles.count; ++i) {
+        if (!seeded[i]) {
+            slots[_CollisionSweepKey(circles, i)] = COLLISION_SWEEP_NO_SLOT;
+            fresh[fresh_count++] = (CollisionSweepItem){.min_x = circles.x[i] - circles.radius[i], .max_x = circles.x[i] + circles.radius[i], .index = i};
+        }
+    }
+    qsort(fresh, fresh_count, sizeof(CollisionSweepItem), _CollisionSweepItemCompare);
+
+    CollisionSweepItem* items = ArenaPushArray(scratch, CollisionSweepItem, circles.count);
+    for (u32 i = 0, k = 0, f = 0; i < circles.count; ++i) {
+        items[i] = (f == fresh_count || (k < kept_count && kept[k].min_x <= fresh[f].min_x)) ? kept[k++] : fresh[f++];
+    }
+
+    if (order->capacity < circles.count) {
+        order->capacity = max(circles.count, order->capacity * 2);
+        order->keys = (u32*)realloc(order->keys, sizeof(u32) * order->capacity);
+    }
+    for (u32 i = 0; i < circles.count; ++i) { order->keys[i] = _CollisionSweepKey(circles, items[i].index); }
+    order->count = circles.count;
+
+    return items;
+}
+
+// One active list per layer, so circles are only tested against the layers of their mask.
+// Each pair is found when its second circle is reached.
+void _CollisionSweep(CollisionCircles circles, CollisionPairs* pairs, Arena* scratch) {
+    CollisionSweepItem* items = _CollisionSweepSort(circles, &pairs->sweep, scratch);
+
+    u32 layer_counts[COLLISION_MAX_LAYERS] = {0};
+    for (u32 i = 0; i < circles.count; ++i) { ++layer_counts[circles.layers[i]]; }
+
+    CollisionSweepItem* active[COLLISION_MAX_LAYERS];
+    u32 active_counts[COLLISION_MAX_LAYERS] = {0};
+    for (u32 layer = 0; layer < COLLISION_MAX_LAYERS; ++layer) {
+        active[layer] = layer_counts[layer] > 0 ? ArenaPushArray(scratch, CollisionSweepItem, layer_counts[layer]) : NULL;
+    }
+
+    for (u32 s = 0; s < circles.count; ++s) {
+        CollisionSweepItem item = items[s];
+
+        // Tests the circle against the active circles of its mask, dropping the ones left behind by the sweep
+        for (u32 layers = circles.masks[item.index]; layers; layers &= layers - 1) {
+            u32 layer = __builtin_ctz(layers);
+            CollisionSweepItem* layer_active = active[layer];
+
+            for (u32 k = 0; k < active_counts[layer];) {
+                if (layer_active[k].max_x < item.min_x) {
+                    layer_active[k] = layer_active[--active_counts[layer]];
+                    continue;
+                }
+
+                u32 i = min(item.index, layer_active[k].index), j = max(item.index, layer_active[k].index);
+                if (_CollisionCirclesMatch(circles, i, j) && _CollisionCirclesOverlap(circles, i, circles, j)) { _CollisionPairsAdd(pairs, i, j); }
+                ++k;
+            }
+        }
+
+        u32 layer = circles.layers[item.index];
+        active[layer][active_counts[layer]++] = item;
+    }
+}
+
+void CollisionCirclesOverlaps(CollisionBroadphase broadphase, CollisionCircles circles, CollisionPairs* pairs, JobSystem* jobs, Arena* scratch) {
+    pairs->count = 0;
+    if (circles.count < 2) { return; }
+
+    // The parallel searches confirm the motion of their pairs on the jobs
+    ArenaScope(scratch, scratch_marker) {
+        switch (broadphase) {
+            case COLLISION_BROADPHASE_GRID: _CollisionGrid(circles, pairs, jobs, scratch); break;
+            case COLLISION_BROADPHASE_SWEEP:
+                _CollisionSweep(circles, pairs, scratch);
+                if (circles.moving_count > 0) { _CollisionSweptFilter(circles, pairs); }
+                break;
+            case COLLISION_BROADPHASE_BRUTE_FORCE:
+            default: _CollisionBruteForce(circles, pairs, jobs); break;
+        }
+    }
+}
+
+const char* CollisionBroadphaseName(CollisionBroadphase broadphase) {
+    switch (broadphase) {
+        case COLLISION_BROADPHASE_BRUTE_FORCE: return "brute force";
+        case COLLISION_BROADPHASE_GRID: return "grid";
+        case COLLISION_BROADPHASE_SWEEP: return "sweep and prune";
+        default: return "unknown";
+    }
+}
+
+// ----------------------------------------------------------------------------
+// ---- Collision world -------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+CollisionWorld CollisionWorldCreate(CollisionBroadphase broadphase, JobSystem* jobs) { return (CollisionWorld){.broadphase = broadphase, .jobs = jobs}; }
+
+void CollisionWorldDelete(CollisionWorld* world) { CollisionPairsDelete(&world->pairs); }
+
+void CollisionWorldEventSet(CollisionWorld* world, u8 layer_a, u8 layer_b, u8 kind) {
+    world->rules[layer_b][layer_a] = (CollisionEventRule){.kind = kind, .swapped = true};
+    world->rules[layer_a][layer_b] = (CollisionEventRule){.kind = kind, .swapped = false};
+}
+
+void CollisionWorldBegin(CollisionWorld* world, Arena* arena, u32 capacity, u32 id_limit) {
+    world->circles = CollisionCirclesCreate(arena, capacity, id_limit);
+}
+
+u32 CollisionWorldAdd(CollisionWorld* world, Vector2 center, f32 radius, u32 id, u8 layer, u16 mask) {
+    return CollisionCirclesAdd(&world->circles, center, radius, id, layer, mask);
+}
+
+u32 CollisionWorldAddSwept(CollisionWorld* world, Vector2 start, Vector2 end, f32 radius, u32 id, u8 layer, u16 mask) {
+    return CollisionCirclesAddSwept(&world->circles, start, end, radius, id, layer, mask);
+}
+
+void CollisionWorldUpdate(CollisionWorld* world, Arena* scratch) {
+    CollisionCirclesOverlaps(world->broadphase, world->circles, &world->pairs, world->jobs, scratch);
+}
+
+// Counting sort of the pairs by the kind of their events
+CollisionEvents CollisionWorldEvents(const CollisionWorld* world, Arena* arena) {
+    CollisionEvents events = {.events = ArenaPushArray(arena, CollisionEvent, world->pairs.count), .count = 0, .kind_starts = {0}};
+    CollisionEventRule* rules = ArenaPushArray(arena, CollisionEventRule, world->pairs.count);
+
+    for (u32 p = 0; p < world->pairs.count; ++p) {
+        CollisionPair pair = world->pairs.pairs[p];
+        rules[p] = world->rules[world->circles.layers[pair.a]][world->circles.layers[pair.b]];
+        ++events.kind_starts[rules[p].kind + 1];
+    }
+    events.kind_starts[COLLISION_EVENT_NONE + 1] = 0;  // Ignored pairs are dropped
+    for (u32 kind = 1; kind <= COLLISION_MAX_EVENT_KINDS; ++kind) { events.kind_starts[kind] += events.kind_starts[kind - 1]; }
+    events.count = events.kind_starts[COLLISION_MAX_EVENT_KINDS];
+
+    u32 kind_ends[COLLISION_MAX_EVENT_KINDS];
+    memory_copy(kind_ends, events.kind_starts, sizeof(kind_ends));
+    for (u32 p = 0; p < world->pairs.count; ++p) {
+        if (rules[p].kind == COLLISION_EVENT_NONE) { continue; }
+
+        CollisionPair pair = world->pairs.pairs[p];
+        events.events[kind_ends[rules[p].kind]++] = rules[p].swapped ? (CollisionEvent){.a = pair.b, .b = pair.a, .kind = rules[p].kind}
+                                                                     : (CollisionEvent){.a = pair.a, .b = pair.b, .kind = rules[p].kind};
+    }
+
+    return events;
+}
@@ -3,6 +3,10 @@
 #define COLLISIONS_H
 
 #include "entities/entities.h"
+#include "types/arena.h"
+#include "types/ecs.h"
+#include "types/jobs.h"
+#include "types/types.h"
 
 // ----------------------------------------------------------------------------
 // ---- Collisions ------------------------------------------------------------
@@ -10,4 +14,280 @@
 
 bool CheckEntityCollision(Entity e1, Entity e2);
 
-#endif  // COLLISIONS_H
\ No newline at end of file
+// ----------------------------------------------------------------------------
+// ---- Collision circles -----------------------------------------------------
+// ----------------------------------------------------------------------------
+
+#define COLLISION_MAX_LAYERS    16                     // Layers available, one bit each on the collision masks
+#define COLLISION_ID_INDEX_MASK ECS_ENTITY_INDEX_MASK  // Bits of an id that tell apart the entities alive at once, the record of an ECS handle
+
+#define CollisionLayerBit(layer) ((u16)(1u << (layer)))  // Bit of a layer on a collision mask
+
+/**
+ * Bounding circles of a group of entities, stored as separate arrays so they can be scanned fast.
+ * Two circles can only collide if the mask of each one has the bit of the layer of the other.
+ * Circles can move in a straight line during the step. The broadphase then uses a circle covering the whole motion,
+ * and the pairs are confirmed with the closest approach of both circles, so fast circles can not tunnel through others.
+ */
+typedef struct CollisionCircles {
+    f32* x;            // Center position on the x axis, at the middle of the motion
+    f32* y;            // Center position on the y axis, at the middle of the motion
+    f32* radius;       // Radius covering the circle along its whole motion
+    f32* body_radius;  // Radius of the circle itself
+    f32* motion_x;     // Movement on the x axis during the step
+    f32* motion_y;     // Movement on the y axis during the step
+    u32* ids;          // Identifier of the entity of the circle, such as its ECS handle
+    u8* layers;        // Layer of the circle
+    u16* masks;        // Layers the circle collides with
+    u32 count;         // Number of circles
+    u32 capacity;      // Maximum number of circles
+    u32 id_limit;      // Bound of the ids masked with `COLLISION_ID_INDEX_MASK`, sizes the tables indexed by entity
+    f32 max_radius;    // Biggest radius of all the circles
+    u32 moving_count;  // Circles that move during the step
+} CollisionCircles;
+
+/**
+ * Overlap between two circles of a group, as their indices on the group, with `a` lower than `b`.
+ */
+typedef struct CollisionPair {
+    u32 a;
+    u32 b;
+} CollisionPair;
+
+/**
+ * Keys of a group of circles in the order of the last sweep, to sort them faster on the next one.
+ */
+typedef struct CollisionSweepOrder {
+    u32* keys;
+    u32 count;
+    u32 capacity;
+
+    u32* slots;  // Circle of every key during a sweep, left empty between sweeps so only the keys in use are cleared
+    u32 slot_capacity;
+} CollisionSweepOrder;
+
+/**
+ * Growable list of collision pairs, kept between frames to reuse its memory and the order of the last sweep.
+ */
+typedef struct CollisionPairs {
+    CollisionPair* pairs;
+    u32 count;
+    u32 capacity;
+
+    CollisionSweepOrder sweep;  // Order of the circles on the last sweep
+
+    struct CollisionPairs* chunks;  // Pairs found by every job of the last parallel search, merged in order
+    u32 chunk_capacity;
+} CollisionPairs;
+
+/**
+ * Algorithm used to find the circles that can overlap.
+ */
+typedef enum CollisionBroadphase {
+    COLLISION_BROADPHASE_BRUTE_FORCE = 0,  // Tests every circle against every other circle
+    COLLISION_BROADPHASE_GRID,             // Tests only the circles on the neighbouring cells of a uniform grid
+    COLLISION_BROADPHASE_SWEEP,            // Tests only the circles whose extents overlap on the x axis
+    COLLISION_BROADPHASE_COUNT,
+} CollisionBroadphase;
+
+#define COLLISION_BATCH_SIZE            64   // Maximum circles tested at once by the batch test
+#define COLLISION_GRID_MIN_CELL_SIZE    8    // Smallest side of a grid cell
+#define COLLISION_GRID_CELLS_PER_CIRCLE 4    // Maximum grid cells per circle, the cells grow to stay below it
+#define COLLISION_JOB_CIRCLES           256  // Circles tested by every job of a parallel search
+
+/**
+ * Creates an empty group of collision circles.
+ * @param arena Arena where to reserve the circles. Usually the frame arena.
+ * @param capacity Maximum number of circles.
+ * @param id_limit Bound of the ids of the circles masked with `COLLISION_ID_INDEX_MASK`, such as the record count of an ECS world.
+ * @return New group of circles.
+ */
+CollisionCircles CollisionCirclesCreate(Arena* arena, u32 capacity, u32 id_limit);
+/**
+ * Appends a still circle to a group of collision circles.
+ * @param circles Circles to use.
+ * @param center Center of the circle.
+ * @param radius Radius of the circle.
+ * @param id Identifier of the entity of the circle.
+ * @param layer Layer of the circle. Lower than `COLLISION_MAX_LAYERS`.
+ * @param mask Layers the circle collides with, made of `CollisionLayerBit`.
+ * @return Index of the circle on the group.
+ */
+u32 CollisionCirclesAdd(CollisionCircles* circles, Vector2 center, f32 radius, u32 id, u8 layer, u16 mask);
+/**
+ * Appends a circle moving in a straight line during the step to a group of collision circles.
+ * @param circles Circles to use.
+ * @param start Center of the circle at the start of the step.
+ * @param end Center of the circle at the end of the step.
+ * @param radius Radius of the circle.
+ * @param id Identifier of the entity of the circle.
+ * @param layer Layer of the circle. Lower than `COLLISION_MAX_LAYERS`.
+ * @param mask Layers the circle collides with, made of `CollisionLayerBit`.
+ * @return Index of the circle on the group.
+ */
+u32 CollisionCirclesAddSwept(CollisionCircles* circles, Vector2 start, Vector2 end, f32 radius, u32 id, u8 layer, u16 mask);
+/**
+ * Retrieves the center of a circle at the end of the step.
+ * @param circles Circles to check.
+ * @param index Index of the circle.
+ * @return Center of the circle.
+ */
+Vector2 CollisionCirclesEnd(CollisionCircles circles, u32 index);
+
+/**
+ * Finds every overlapping pair of circles of a group whose layers and masks match.
+ * The brute force and grid searches are split into jobs by circle, and their pairs merged in the order a single thread finds them.
+ * @param broadphase Algorithm to use.
+ * @param circles Group of circles.
+ * @param pairs List where to store the pairs. Previous pairs are discarded.
+ * @param jobs Job system to run the search on. NULL to search on the calling thread.
+ * @param scratch Arena for the temporary memory of the search. Freed before returning.
+ */
+void CollisionCirclesOverlaps(CollisionBroadphase broadphase, CollisionCircles circles, CollisionPairs* pairs, JobSystem* jobs, Arena* scratch);
+
+/**
+ * Tests a circle against a batch of circles stored on consecutive positions, several at a time with SSE or AVX.
+ * Compares squared distances with the same operations as the scalar test, so both give the same results.
+ * @param x Center position of the circle on the x axis.
+ * @param y Center position of the circle on the y axis.
+ * @param radius Radius of the circle.
+ * @param xs Center positions of the batch on the x axis.
+ * @param ys Center positions of the batch on the y axis.
+ * @param radiuses Radiuses of the batch.
+ * @param count Number of circles of the batch. Up to `COLLISION_BATCH_SIZE`.
+ * @return Mask with the bit `k` set if the circle overlaps the circle `k` of the batch.
+ */
+u64 CollisionCircleOverlapMask(f32 x, f32 y, f32 radius, const f32* xs, const f32* ys, const f32* radiuses, u32 count);
+
+/**
+ * Deletes the memory of a list of collision pairs.
+ * @param pairs Pairs to delete.
+ */
+void CollisionPairsDelete(CollisionPairs* pairs);
+
+/**
+ * Retrieves the name of a broadphase algorithm.
+ * @param broadphase Algorithm to check.
+ * @return Name of the algorithm.
+ */
+const char* CollisionBroadphaseName(CollisionBroadphase broadphase);
+
+// ----------------------------------------------------------------------------
+// ---- Collision world -------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+#define COLLISION_MAX_EVENT_KINDS 16  // Kinds of collision events available
+#define COLLISION_EVENT_NONE      0   // Kind of the pairs of layers that are ignored
+
+/**
+ * Overlap between the circles of two layers, for the game to resolve after the detection.
+ */
+typedef struct CollisionEvent {
+    u32 a;    // Index of the circle of the first layer of the rule
+    u32 b;    // Index of the circle of the second layer of the rule
+    u8 kind;  // Kind of the event
+} CollisionEvent;
+
+/**
+ * Collision events of a frame grouped by kind.
+ */
+typedef struct CollisionEvents {
+    CollisionEvent* events;
+    u32 count;
+    u32 kind_starts[COLLISION_MAX_EVENT_KINDS + 1];  // First event of each kind, followed by the number of events
+} CollisionEvents;
+
+/**
+ * Kind of the events of a pair of layers, with its circles swapped when the pair was found on the opposite order.
+ */
+typedef struct CollisionEventRule {
+    u8 kind;
+    bool swapped;
+} CollisionEventRule;
+
+/**
+ * Circles of all the entities of a frame, checked on a single broadphase pass.
+ * Pairs become events of the kind set for their pair of layers.
+ */
+typedef struct CollisionWorld {
+    CollisionCircles circles;  // Circles of the frame
+    CollisionPairs pairs;      // Pairs of the last update
+    CollisionBroadphase broadphase;
+    JobSystem* jobs;  // Job system of the searches, NULL to run them on the calling thread
+    CollisionEventRule rules[COLLISION_MAX_LAYERS][COLLISION_MAX_LAYERS];
+} CollisionWorld;
+
+/**
+ * Creates an empty collision world.
+ * @param broadphase Algorithm to find the pairs.
+ * @param jobs Job system to find the pairs on. NULL to find them on the calling thread.
+ * @return New collision world.
+ */
+CollisionWorld CollisionWorldCreate(CollisionBroadphase broadphase, JobSystem* jobs);
+/**
+ * Deletes the memory of a collision world.
+ * @param world World to delete.
+ */
+void CollisionWorldDelete(CollisionWorld* world);
+
+/**
+ * Sets the kind of the events of the overlapping pairs of two layers.
+ * @param world World to use.
+ * @param layer_a Layer of the first circle of the events.
+ * @param layer_b Layer of the second circle of the events.
+ * @param kind Kind of the events, lower than `COLLISION_MAX_EVENT_KINDS`. `COLLISION_EVENT_NONE` to ignore the pairs.
+ */
+void CollisionWorldEventSet(CollisionWorld* world, u8 layer_a, u8 layer_b, u8 kind);
+
+/**
+ * Discards the circles of the last frame and reserves space for the new ones.
+ * @param world World to use.
+ * @param arena Arena where to reserve the circles. Usually the frame arena.
+ * @param capacity Maximum number of circles of the frame.
+ * @param id_limit Bound of the ids of the circles masked with `COLLISION_ID_INDEX_MASK`, such as the record count of an ECS world.
+ */
+void CollisionWorldBegin(CollisionWorld* world, Arena* arena, u32 capacity, u32 id_limit);
+/**
+ * Registers the bounding circle of an entity on a collision world.
+ * @param world World to use.
+ * @param center Center of the circle.
+ * @param radius Radius of the circle.
+ * @param id Identifier of the entity of the circle.
+ * @param layer Layer of the circle.
+ * @param mask Layers the circle collides with.
+ * @return Index of the circle on the world.
+ */
+u32 CollisionWorldAdd(CollisionWorld* world, Vector2 center, f32 radius, u32 id, u8 layer, u16 mask);
+/**
+ * Registers the bounding circle of an entity moving in a straight line during the step on a collision world.
+ * @param world World to use.
+ * @param start Center of the circle at the start of the step.
+ * @param end Center of the circle at the end of the step.
+ * @param radius Radius of the circle.
+ * @param id Identifier of the entity of the circle.
+ * @param layer Layer of the circle.
+ * @param mask Layers the circle collides with.
+ * @return Index of the circle on the world.
+ */
+u32 CollisionWorldAddSwept(CollisionWorld* world, Vector2 start, Vector2 end, f32 radius, u32 id, u8 layer, u16 mask);
+/**
+ * Finds the overlapping pairs of the circles of a collision world.
+ * @param world World to use.
+ * @param scratch Arena for the temporary memory of the search.
+ */
+void CollisionWorldUpdate(CollisionWorld* world, Arena* scratch);
+/**
+ * Turns the pairs found on the last update into events grouped by kind. Does not modify the world.
+ * @param world World to use.
+ * @param arena Arena where to reserve the events. Usually the frame arena.
+ * @return Events of the pairs, in the order they were found within each kind.
+ */
+CollisionEvents CollisionWorldEvents(const CollisionWorld* world, Arena* arena);
+
+// Iterates over the collision events of a kind
+#define ForEachCollisionEvent(collision_events, event_kind, iteration_var)                                             \
+    for (const CollisionEvent* iteration_var = (collision_events).events + (collision_events).kind_starts[event_kind]; \
+         iteration_var < (collision_events).events + (collision_events).kind_starts[(event_kind) + 1];                 \
+         ++iteration_var)
+
+#endif  // COLLISIONS_H
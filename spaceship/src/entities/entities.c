@@ -1,4 +1,6 @@
+#include <assert.h>
 #include <math.h>
+#include <stdlib.h>
 
 #include "abilities/abilities.h"
 #include "control/actions.h"
@@ -14,16 +16,6 @@
 // ---- Entity ----------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-void _EntityBoundingCircleDraw(Entity entity, Color color, bool fill) {
-    if (state->testing_draw_bounding_circles) {
-        if (fill) {
-            DrawCircleV(EntityBoundingCircleCenter(entity), entity.bounding_circle.radius, color);
-        } else {
-            DrawCircleLinesV(EntityBoundingCircleCenter(entity), entity.bounding_circle.radius, color);
-        }
-    }
-}
-
 void EntitySetRotation(Entity* entity, f32 rotation) {
     entity->rotation = rotation;
     entity->bounding_circle._center_rotated = Vector2Rotate(entity->bounding_circle.center, rotation + entity->_draw_rotation);
@@ -42,8 +34,6 @@ void EntityDraw(Entity entity, Rectangle texture_location) {
                    size_center,
                    Rad2Deg(entity.rotation + entity._draw_rotation),
                    WHITE);
-
-    _EntityBoundingCircleDraw(entity, Fade(LIME, 0.5), false);
 }
 
 // ----------------------------------------------------------------------------
@@ -67,51 +57,59 @@ void HealthBarDraw(Health health, Entity entity, Color border_color, Color healt
     DrawRectangleV(health_draw_position, health_size, health_color);
 }
 
+// ----------------------------------------------------------------------------
+// ---- Components ------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+Entity SpriteEntity(Position position, Sprite sprite) {
+    return (Entity){.position = position, .size = sprite.size, .rotation = sprite.rotation, ._draw_rotation = sprite.draw_rotation};
+}
+
+void SpriteDraw(Position position, Sprite sprite) { EntityDraw(SpriteEntity(position, sprite), sprite.texture_location); }
+
 // ----------------------------------------------------------------------------
 // ---- Proyectile ------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-Projectile* ProjectileCreate(
+EcsEntity ProjectileCreate(
     ProjectileType type, Vector2 position, Vector2 size, f32 projectile_speed, f32 rotation, BoundingCircle bounding_circle, u32 damage, u32 range) {
-    Projectile projectile = {
-        .type = type,
-        .entity =
-            {
-                .position = position,
-                .size = size,
-                .movement_speed = Vector2Scale(Vector2UnitCirclePoint(rotation), projectile_speed),
-                .velocity = {0},
-                .rotation = rotation,
-                ._draw_rotation = PROJECTILE_DRAW_ROTATION,
-                .bounding_circle = bounding_circle,
-            },
-        .damage = damage,
-        .range = range,
-
-        ._origin = position,
+    EcsWorld* world = &state->world;
+    EcsEntity projectile = EcsEntityCreate(world, ARCHETYPE_PROJECTILE);
+    assert(EcsEntityIsAlive(world, projectile) && "No archetype left for the projectiles, raise ECS_MAX_ARCHETYPES");
+    bool friendly = type == PROYECTILE_PLAYER;
+
+    *EcsEntityComponentType(world, projectile, COMPONENT_POSITION, Position) = position;
+    *EcsEntityComponentType(world, projectile, COMPONENT_VELOCITY, Velocity) = Vector2Scale(Vector2UnitCirclePoint(rotation), projectile_speed);
+    *EcsEntityComponentType(world, projectile, COMPONENT_COLLIDER, Collider) = (Collider){
+        .offset = Vector2Add(Vector2Scale(size, 0.5f), bounding_circle._center_rotated),
+        .radius = bounding_circle.radius,
+        .layer = friendly ? GAME_COLLISION_LAYER_PROJECTILE_PLAYER : GAME_COLLISION_LAYER_PROJECTILE_ENEMY,
+        .mask = friendly ? GAME_COLLISION_MASK_PROJECTILE_PLAYER : GAME_COLLISION_MASK_PROJECTILE_ENEMY,
+    };
+    *EcsEntityComponentType(world, projectile, COMPONENT_LIFETIME, Lifetime) = range / projectile_speed;
+    *EcsEntityComponentType(world, projectile, COMPONENT_DAMAGE, Damage) = damage;
+    *EcsEntityComponentType(world, projectile, COMPONENT_SPRITE, Sprite) = (Sprite){
+        .texture_location = ProjectileTextureLocation(type),
+        .size = size,
+        .rotation = rotation,
+        .draw_rotation = PROJECTILE_DRAW_ROTATION,
     };
 
-    return (Projectile*)ObjectPoolObjectAdd((type == PROYECTILE_PLAYER ? &state->projectiles_players : &state->projectiles_enemies), &projectile);
-}
-
-bool ProjectileMove(Projectile* projectile) {
-    f32 distance = Vector2Distance(projectile->entity.position, projectile->_origin);
-    u32 range = projectile->range;
-    if (distance < range) {
-        projectile->entity.velocity = Vector2ScaleToDelta(projectile->entity.movement_speed);
-        projectile->entity.position = Vector2Add(projectile->entity.position, projectile->entity.velocity);
-        return true;
-    }
-    return false;
+    return projectile;
 }
 
-void ProjectileDraw(Projectile projectile) { EntityDraw(projectile.entity, ProjectileTextureLocation(projectile.type)); }
-
 // ----------------------------------------------------------------------------
 // ---- Player ----------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-Player PlayerCreate(InputDevice device, u8 player_index, SpaceshipType type, Vector2 position) {
+Player PlayerCreate(InputDeviceID device, u8 player_index, SpaceshipType type, Vector2 position) {
+    BasicInputHandler input = BasicInputHandlerCreate(device, ACTION_TYPES_COUNT);
+    if (device == INPUT_DEVICE_ID_KEYBOARD_AND_MOUSE) {
+        BasicInputHandlerMappingsSet(&input, (InputMap[ACTION_TYPES_COUNT])ACTION_MAPPING_DEFAULT_KEYBOARD_AND_MOUSE);
+    } else {
+        BasicInputHandlerMappingsSet(&input, (InputMap[ACTION_TYPES_COUNT])ACTION_MAPPING_DEFAULT_GAMEPAD);
+    }
+
     f32 rotation = 0;
     return (Player){
         .entity = {.position = position,
@@ -132,35 +130,22 @@ Player PlayerCreate(InputDevice device, u8 player_index, SpaceshipType type, Vec
 
         ._player_index = player_index,
         ._alternate_shooting = true,
-        ._device = device,
+        ._input = input,
     };
 }
 
-f32 PlayerGetAction(Player player, Action action) {
-    InputDevice device = player._device;
-    Mapping mapping = state->mappings[device][action];
+void PlayerDelete(Player* player) { BasicInputHandlerDelete(&player->_input); }
 
-    if (device == INPUT_DEVICE_MOUSE_AND_KEYBOARD) {
-        switch (mapping.method) {
-            case INPUT_METHOD_MOUSE_BUTTON: return IsInputMouseButtonDown(mapping.value);
-            case INPUT_METHOD_KEYBOARD_KEY: return IsInputKeyboardKeyDown(mapping.value);
-            case INPUT_METHOD_CURSOR_POSITION: return InputMouseCursorPosition(mapping.value, EntityCenter(player.entity));
-            default: break;
-        }
-    } else if (device >= 0) {
-        switch (mapping.method) {
-            case INPUT_METHOD_GAMEPAD_BUTTON: return IsInputGamepadButtonDown(device, mapping.value);
-            case INPUT_METHOD_GAMEPAD_TRIGGER: return InputGamepadTriggerPressure(device, mapping.value);
-            case INPUT_METHOD_GAMEPAD_JOYSTICK: return InputGamepadJoystickOffset(device, mapping.value);
-            default: break;
-        }
-    }
-    return 0;
+void PlayerSampleActions(Player* player) {
+    for (Action action = 0; action < ACTION_TYPES_COUNT; ++action) { player->_actions[action] = BasicInputHandlerGetValue(player->_input, action).f; }
 }
 
+f32 PlayerGetAction(Player player, Action action) { return player._actions[action]; }
+
 void PlayerMove(Player* player) {
-    f32 move_x = PlayerGetAction(*player, ACTION_MOVE_RIGHT) - PlayerGetAction(*player, ACTION_MOVE_LEFT);
-    f32 move_y = PlayerGetAction(*player, ACTION_MOVE_DOWN) - PlayerGetAction(*player, ACTION_MOVE_UP);
+    // Joysticks give negative values on the up and left ranges
+    f32 move_x = fabsf(PlayerGetAction(*player, ACTION_MOVE_RIGHT)) - fabsf(PlayerGetAction(*player, ACTION_MOVE_LEFT));
+    f32 move_y = fabsf(PlayerGetAction(*player, ACTION_MOVE_DOWN)) - fabsf(PlayerGetAction(*player, ACTION_MOVE_UP));
 
     player->entity.velocity = Vector2Zero();
 
@@ -173,8 +158,8 @@ void PlayerMove(Player* player) {
 }
 
 void PlayerAim(Player* player) {
-    Vector2 aim_delta = {PlayerGetAction(*player, ACTION_AIM_RIGHT) - PlayerGetAction(*player, ACTION_AIM_LEFT),
-                         PlayerGetAction(*player, ACTION_AIM_DOWN) - PlayerGetAction(*player, ACTION_AIM_UP)};
+    Vector2 aim_delta = {PlayerGetAction(*player, ACTION_AIM_X), PlayerGetAction(*player, ACTION_AIM_Y)};
+    if (player->_input.device == INPUT_DEVICE_ID_KEYBOARD_AND_MOUSE) { aim_delta = Vector2Subtract(aim_delta, EntityCenter(player->entity)); }  // Aims at the cursor
 
     if (aim_delta.x == 0 && aim_delta.y == 0) {
         aim_delta = player->entity.velocity;
@@ -281,32 +266,39 @@ void PlayerDraw(Player player) {
 // ---- Enemy -----------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-Enemy* EnemyCreate(SpaceshipType type, Vector2 position, Vector2 movement_speed, f32 rotation) {
-    Enemy enemy = {.entity = {.position = position,
-                              .size = ENEMY_SIZE,
-                              .movement_speed = movement_speed,
-                              .rotation = rotation,
-                              ._draw_rotation = ENEMY_DRAW_ROTATION,
-                              .bounding_circle = ENEMY_BOUNDING_CIRCLE(rotation)},
-                   .type = type,
-                   .health = ENEMY_HEALTH,
-
-                   .ability_shooting = ENEMY_ABILITY_SHOOT};
+EcsEntity EnemyCreate(SpaceshipType type, Vector2 position, f32 rotation) {
+    EcsWorld* world = &state->world;
+    EcsEntity enemy = EcsEntityCreate(world, ARCHETYPE_ENEMY);
+    assert(EcsEntityIsAlive(world, enemy) && "No archetype left for the enemies, raise ECS_MAX_ARCHETYPES");
+    BoundingCircle bounding_circle = ENEMY_BOUNDING_CIRCLE(rotation);
+
+    *EcsEntityComponentType(world, enemy, COMPONENT_POSITION, Position) = position;
+    *EcsEntityComponentType(world, enemy, COMPONENT_VELOCITY, Velocity) = Vector2Zero();
+    *EcsEntityComponentType(world, enemy, COMPONENT_COLLIDER, Collider) = (Collider){
+        .offset = Vector2Add(Vector2Scale(ENEMY_SIZE, 0.5f), bounding_circle._center_rotated),
+        .radius = bounding_circle.radius,
+        .layer = GAME_COLLISION_LAYER_ENEMY,
+        .mask = GAME_COLLISION_MASK_ENEMY,
+    };
+    *EcsEntityComponentType(world, enemy, COMPONENT_HEALTH, Health) = ENEMY_HEALTH;
+    *EcsEntityComponentType(world, enemy, COMPONENT_COOLDOWN, Cooldown) = ENEMY_ABILITY_SHOOT.cooldown;
+    *EcsEntityComponentType(world, enemy, COMPONENT_SPRITE, Sprite) = (Sprite){
+        .texture_location = SpaceshipTextureLocation(type),
+        .size = ENEMY_SIZE,
+        .rotation = rotation,
+        .draw_rotation = ENEMY_DRAW_ROTATION,
+    };
 
-    return (Enemy*)ObjectPoolObjectAdd(&state->enemies, &enemy);
+    return enemy;
 }
 
-bool EnemyDamage(Enemy* enemy, u32 damage) {
-    if (enemy->health.current <= damage) {
-        enemy->health.current = 0;
+bool EnemyDamage(EcsEntity enemy, u32 damage) {
+    Health* health = EcsEntityComponentType(&state->world, enemy, COMPONENT_HEALTH, Health);
+    if (health->current <= damage) {
+        health->current = 0;
         return true;
     } else {
-        enemy->health.current -= damage;
+        health->current -= damage;
         return false;
     }
 }
-
-void EnemyDraw(Enemy enemy) {
-    EntityDraw(enemy.entity, SpaceshipTextureLocation(enemy.type));
-    HealthBarDraw(enemy.health, enemy.entity, MAROON, RED);
-}
@@ -4,6 +4,7 @@
 
 #include "abilities/abilities.h"
 #include "control/actions.h"
+#include "types/ecs.h"
 #include "raylib/raylib.h"
 
 // ----------------------------------------------------------------------------
@@ -71,17 +72,64 @@ typedef enum ProjectileType {
 } ProjectileType;
 
 // ----------------------------------------------------------------------------
-// ---- Proyectile ------------------------------------------------------------
+// ---- Components ------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-typedef struct Projectile {
-    Entity entity;
-    ProjectileType type;
-    u32 damage;
-    u32 range;
+typedef enum GameComponent {
+    COMPONENT_POSITION = 0,
+    COMPONENT_VELOCITY,
+    COMPONENT_COLLIDER,
+    COMPONENT_HEALTH,
+    COMPONENT_COOLDOWN,
+    COMPONENT_SPRITE,
+    COMPONENT_LIFETIME,
+    COMPONENT_DAMAGE,
+    COMPONENT_COUNT,
+} GameComponent;
+
+// Transform of the entity. Only the position, as the rotation is just drawn and lives on the sprite, so the movement system reads two 8 byte columns.
+// Named apart from the `Transform` of raylib
+typedef Vector2 Position;  // Top-left position
+typedef Vector2 Velocity;  // Movement per second
+
+typedef struct Collider {
+    Vector2 offset;  // Center of the bounding circle from the top-left position
+    f32 radius;
+    u8 layer;  // Collision layer of the entity
+    u16 mask;  // Collision layers the entity collides with
+} Collider;
+
+// `Health` and `Cooldown` are used as components as they are
+
+typedef struct Sprite {
+    Rectangle texture_location;
+    Vector2 size;
+    f32 rotation;       // Rotation of the entity in radians
+    f32 draw_rotation;  // Rotation of the base representation of the entity in radians
+} Sprite;
+
+typedef f32 Lifetime;  // Seconds left until the entity is destroyed
+typedef u32 Damage;    // Damage dealt on a hit
+
+// Size of every component, indexed by `GameComponent`
+#define GAME_COMPONENT_SIZES                                                                                                                \
+    ((const usize[COMPONENT_COUNT]){sizeof(Position), sizeof(Velocity), sizeof(Collider), sizeof(Health), sizeof(Cooldown), sizeof(Sprite), \
+                                    sizeof(Lifetime), sizeof(Damage)})
+
+// Component mixes of the entities
+#define ARCHETYPE_ENEMY                                                                                                \
+    (EcsComponentBit(COMPONENT_POSITION) | EcsComponentBit(COMPONENT_VELOCITY) | EcsComponentBit(COMPONENT_COLLIDER) | \
+     EcsComponentBit(COMPONENT_HEALTH) | EcsComponentBit(COMPONENT_COOLDOWN) | EcsComponentBit(COMPONENT_SPRITE))
+#define ARCHETYPE_PROJECTILE                                                                                           \
+    (EcsComponentBit(COMPONENT_POSITION) | EcsComponentBit(COMPONENT_VELOCITY) | EcsComponentBit(COMPONENT_COLLIDER) | \
+     EcsComponentBit(COMPONENT_LIFETIME) | EcsComponentBit(COMPONENT_DAMAGE) | EcsComponentBit(COMPONENT_SPRITE))
+
+Entity SpriteEntity(Position position, Sprite sprite);  // Entity drawn by a sprite, to share the drawing functions with the players
+void SpriteDraw(Position position, Sprite sprite);
 
-    Vector2 _origin;
-} Projectile;
+// ----------------------------------------------------------------------------
+// ---- Proyectile ------------------------------------------------------------
+// ----------------------------------------------------------------------------
 
 #define PROJECTILE_DRAW_ROTATION PI_HALF
 
@@ -100,13 +148,9 @@ typedef struct Projectile {
     BOUNDING_CIRCLE_DEFINITION(                      \
         0, PROJECTILE_MISSILE_SIZE_X - (PROJECTILE_MISSILE_SIZE_Y * 0.5f), PROJECTILE_MISSILE_SIZE_X, rotation + PROJECTILE_DRAW_ROTATION)
 
-Projectile* ProjectileCreate(
+EcsEntity ProjectileCreate(
     ProjectileType type, Vector2 position, Vector2 size, f32 projectile_speed, f32 rotation, BoundingCircle bounding_circle, u32 damage, u32 range);
 
-bool ProjectileMove(Projectile* projectile);  // True if the projectile should be eliminated for surpassing maximum range
-
-void ProjectileDraw(Projectile projectile);
-
 // ----------------------------------------------------------------------------
 // ---- Player ----------------------------------------------------------------
 // ----------------------------------------------------------------------------
@@ -123,7 +167,8 @@ typedef struct Player {
 
     u8 _player_index;
     bool _alternate_shooting;
-    InputDevice _device;
+    BasicInputHandler _input;          // Mappings of the input device of the player
+    f32 _actions[ACTION_TYPES_COUNT];  // Action values of the current tick
 } Player;
 
 // Player intrinsics
@@ -164,9 +209,11 @@ typedef struct Player {
 
 #define PLAYER_ACTION_MOVE_THRESHOLD 0.15f
 
-Player PlayerCreate(InputDevice device, u8 player_index, SpaceshipType type, Vector2 position);
+Player PlayerCreate(InputDeviceID device, u8 player_index, SpaceshipType type, Vector2 position);  // Mapped with the defaults of the device
+void PlayerDelete(Player* player);
 
-f32 PlayerGetAction(Player player, Action action);
+void PlayerSampleActions(Player* player);           // Reads the values of all the actions from the input device, once per tick
+f32 PlayerGetAction(Player player, Action action);  // Value of an action on the current tick
 
 void PlayerMove(Player* player);
 void PlayerAim(Player* player);
@@ -180,15 +227,6 @@ void PlayerDraw(Player player);
 // ---- Enemy -----------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-typedef struct Enemy {
-    Entity entity;
-    SpaceshipType type;
-    Health health;
-
-    AbilityRegen ability_regeneration;
-    AbilityProjectile ability_shooting;
-} Enemy;
-
 // Enemy intrinsics
 #define ENEMY_DRAW_ROTATION             PI_HALF
 #define ENEMY_MOVEMENT_SPEED            ((Vector2){100, 100})
@@ -215,10 +253,8 @@ typedef struct Enemy {
 #define ENEMY_ABILITY_SHOOT_COOLDOWN_TIME (PLAYER_ABILITY_SHOOT_COOLDOWN_TIME * 2)
 #define ENEMY_ABILITY_SHOOT               ABILITY_PROJECTILE_DEFINITION(ENEMY_ABILITY_SHOOT_DAMAGE, ENEMY_ABILITY_SHOOT_RANGE, ENEMY_ABILITY_SHOOT_COOLDOWN_TIME)
 
-Enemy* EnemyCreate(SpaceshipType type, Vector2 position, Vector2 movement_speed, f32 rotation);
-
-bool EnemyDamage(Enemy* enemy, u32 damage);  // True if the enemy should be eliminated
+EcsEntity EnemyCreate(SpaceshipType type, Vector2 position, f32 rotation);
 
-void EnemyDraw(Enemy enemy);
+bool EnemyDamage(EcsEntity enemy, u32 damage);  // True if the enemy should be eliminated
 
 #endif  // ENTITY_H
\ No newline at end of file
@@ -2,7 +2,61 @@
 #include "debug/game_debug.h"
 #include "lifecycles/game_lifecycle.h"
 #include "lifecycles/game_state.h"
-#include "types/object_pool.h"
+#include "types/ecs.h"
+#include "raylib/raymath.h"
+
+// Check if the entity of a collision circle is still alive
+bool _GameDrawCircleIsAlive(GameCollisionLayer layer, u32 id) {
+    return layer == GAME_COLLISION_LAYER_PLAYER || EcsEntityIsAlive(&state->world, (EcsEntity){id});
+}
+
+// Draw the players between the last two ticks
+void _GameDrawPlayers(void) {
+    ForEachPlayerVal(iter) {
+        Player player = iter.player;
+        player.entity.position = Vector2InterpolateTicks(player.entity.position, player.entity.velocity);  // Velocity of players is the movement of the tick
+        PlayerDraw(player);
+    }
+}
+
+// Draw the entities with a sprite between the last two ticks, and the health bars of the ones with health
+void _GameDrawSprites(void) {
+    ForEachEcsArchetype(&state->world, EcsComponentBit(COMPONENT_POSITION) | EcsComponentBit(COMPONENT_SPRITE), iter) {
+        const Position* positions = EcsColumn(iter.archetype, COMPONENT_POSITION, Position);
+        const Sprite* sprites = EcsColumn(iter.archetype, COMPONENT_SPRITE, Sprite);
+        const Velocity* velocities = iter.archetype->mask & EcsComponentBit(COMPONENT_VELOCITY) ? EcsColumn(iter.archetype, COMPONENT_VELOCITY, Velocity) : NULL;
+        const Health* healths = iter.archetype->mask & EcsComponentBit(COMPONENT_HEALTH) ? EcsColumn(iter.archetype, COMPONENT_HEALTH, Health) : NULL;
+
+        for (u32 row = 0; row < iter.archetype->count; ++row) {
+            Position position = velocities != NULL ? Vector2InterpolateTicks(positions[row], Vector2Scale(velocities[row], GAME_STATE_TICK_DELTA)) : positions[row];
+
+            SpriteDraw(position, sprites[row]);
+            if (healths != NULL) { HealthBarDraw(healths[row], SpriteEntity(position, sprites[row]), MAROON, RED); }
+        }
+    }
+}
+
+// Center of a bounding circle between the last two ticks, moved along the same step as its sprite
+Vector2 _GameDrawCircleCenter(CollisionCircles circles, u32 index) {
+    Vector2 end = CollisionCirclesEnd(circles, index);
+    if (circles.layers[index] == GAME_COLLISION_LAYER_PLAYER) { return Vector2InterpolateTicks(end, state->players[circles.ids[index]].entity.velocity); }
+    return Vector2InterpolateTicks(end, (Vector2){circles.motion_x[index], circles.motion_y[index]});  // Swept along the movement of the tick
+}
+
+// Draw the bounding circles of the frame still alive after the collision checks, between the last two ticks as the sprites
+void _GameDrawBoundingCircles(CollisionCircles circles) {
+    for (u32 i = 0; i < circles.count; ++i) {
+        if (_GameDrawCircleIsAlive(circles.layers[i], circles.ids[i])) {
+            DrawCircleLinesV(_GameDrawCircleCenter(circles, i), circles.body_radius[i], Fade(LIME, 0.5));
+
+            // Movement of the step tested for collisions, kept at the positions of the last tick
+            if (circles.motion_x[i] != 0 || circles.motion_y[i] != 0) {
+                Vector2 end = CollisionCirclesEnd(circles, i);
+                DrawLineV(Vector2Subtract(end, (Vector2){circles.motion_x[i], circles.motion_y[i]}), end, Fade(LIME, 0.5));
+            }
+        }
+    }
+}
 
 // Game draw
 void GameDraw(void) {
@@ -11,14 +65,13 @@ void GameDraw(void) {
     ClearBackground(BLANK);
 
     // Players
-    ForEachPlayerVal(iter) { PlayerDraw(iter.player); }
+    _GameDrawPlayers();
 
-    // Enemies
-    ForEachObjectPoolObject(&state->enemies, Enemy, iter) { EnemyDraw(*iter.object); }
+    // Enemies and proyectiles
+    _GameDrawSprites();
 
-    // Proyectiles
-    ForEachObjectPoolObject(&state->projectiles_players, Projectile, iter) { ProjectileDraw(*iter.object); }
-    ForEachObjectPoolObject(&state->projectiles_enemies, Projectile, iter) { ProjectileDraw(*iter.object); }
+    // Bounding circles
+    if (state->testing_draw_bounding_circles) { _GameDrawBoundingCircles(state->collision_world.circles); }
 
 #ifdef DEBUG
     GameDebugDraw();
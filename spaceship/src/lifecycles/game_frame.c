@@ -3,17 +3,24 @@
 #include "debug/game_debug.h"
 #include "lifecycles/game_lifecycle.h"
 #include "lifecycles/game_state.h"
-#include "types/object_pool.h"
+#include "types/ecs.h"
 #include "raylib/raymath.h"
 
 void GameUpdatePlayers(void);
-void GameUpdateProyectiles(void);
+void GameUpdateMovement(void);
+void GameUpdateLifetimes(void);
+void GameSetupCollisions(void);
+void GameUpdateCollisionCircles(void);
 void GameCheckCollisions(void);
+void GameResolveCollisions(CollisionEvents events, Arena* arena);
 
 void TestingInput(void);
+void TestingCommands(void);
 
 // All the calculations that happen at every frame
 void GameFrame(void) {
+    EcsWorldStatsFrameReset(&state->world);
+
 #ifdef DEBUG
     GameDebugInput();
 #endif  // DEBUG
@@ -21,23 +28,51 @@ void GameFrame(void) {
     TestingInput();
 #endif  // TESTING
 
-    if (state->time_running) {
-        // State
-        GameStateUpdate();
-
-        // Entities
-        GameUpdatePlayers();
-        GameUpdateProyectiles();
+    u32 ticks = GameStateAdvanceTime();
+    for (u32 i = 0; i < ticks; ++i) { GameTick(); }
 
-        // Collisions
-        GameCheckCollisions();
-    }
+    // Bounding circles, also needed to draw them on frames without ticks
+    if (ticks == 0) { GameUpdateCollisionCircles(); }
 
 #ifdef DEBUG
     GameDebugUpdate();
 #endif
 }
 
+// Run a stage of the tick, measuring its time
+#define _GameTickStage(stage, call)                          \
+    do {                                                     \
+        f64 stage_start = GetTime();                         \
+        call;                                                \
+        state->stage_times[stage] = GetTime() - stage_start; \
+    } while (0)
+
+// All the calculations of a fixed step of the simulation
+void GameTick(void) {
+    // State
+    GameStateUpdate();
+
+    // Input, read once so replays can store or replace it
+    GameReplayTickInput(&state->replay);
+#ifdef TESTING
+    TestingCommands();
+#endif  // TESTING
+
+    // Entities
+    _GameTickStage(GAME_STAGE_PLAYERS, GameUpdatePlayers());
+    _GameTickStage(GAME_STAGE_MOVEMENT, GameUpdateMovement());
+    _GameTickStage(GAME_STAGE_LIFETIMES, GameUpdateLifetimes());
+
+    // Bounding circles, once after all the movement
+    _GameTickStage(GAME_STAGE_COLLISION_CIRCLES, GameUpdateCollisionCircles());
+
+    // Collisions
+    _GameTickStage(GAME_STAGE_COLLISIONS, GameCheckCollisions());
+
+    // Replay check of the resulting state
+    GameReplayTickEnd(&state->replay);
+}
+
 // Update players
 void GameUpdatePlayers(void) {
     ForEachPlayerRef(iter) {
@@ -51,46 +86,160 @@ void GameUpdatePlayers(void) {
     }
 }
 
-// Update projectiles
-void GameUpdateProyectiles(void) {
-    ObjectPool* pool;
-    ForEachObjectPoolObject(pool = &state->projectiles_players, Projectile, iter) {
-        if (!ProjectileMove(iter.object)) { ObjectPoolObjectRemove(pool, iter.index); }
+// Rows of an archetype column updated by every job of a stage
+#define GAME_JOB_ROWS 4096
+
+typedef struct GameMovementJob {
+    Position* positions;
+    const Velocity* velocities;
+    f32 delta;
+} GameMovementJob;
+
+void _GameMovementJob(void* data, u32 first, u32 last) {
+    GameMovementJob* job = (GameMovementJob*)data;
+    Position* restrict positions = job->positions;
+    const Velocity* restrict velocities = job->velocities;
+    f32 delta = job->delta;
+
+    for (u32 row = first; row < last; ++row) {
+        positions[row].x += velocities[row].x * delta;
+        positions[row].y += velocities[row].y * delta;
+    }
+}
+
+// Move the entities with a velocity. Only the position and velocity columns are touched, and the loop is vectorized.
+// Rows are split into jobs, every row is moved the same on any worker
+void GameUpdateMovement(void) {
+    GameMovementJob archetype_jobs[ECS_MAX_ARCHETYPES];  // One per archetype
+    JobCounter counter = {0};
+
+    ForEachEcsArchetype(&state->world, EcsComponentBit(COMPONENT_POSITION) | EcsComponentBit(COMPONENT_VELOCITY), iter) {
+        GameMovementJob* job = &archetype_jobs[iter.index];
+        *job = (GameMovementJob){.positions = EcsColumn(iter.archetype, COMPONENT_POSITION, Position),
+                                 .velocities = EcsColumn(iter.archetype, COMPONENT_VELOCITY, Velocity),
+                                 .delta = state->time_delta_simulation};
+        JobSystemParallelFor(&state->jobs, iter.archetype->count, GAME_JOB_ROWS, _GameMovementJob, job, &counter);
     }
 
-    ForEachObjectPoolObject(pool = &state->projectiles_enemies, Projectile, iter) {
-        if (!ProjectileMove(iter.object)) { ObjectPoolObjectRemove(pool, iter.index); }
+    JobSystemWait(&state->jobs, &counter);
+}
+
+typedef struct GameLifetimesJob {
+    Lifetime* lifetimes;
+    f32 delta;
+} GameLifetimesJob;
+
+void _GameLifetimesJob(void* data, u32 first, u32 last) {
+    GameLifetimesJob* job = (GameLifetimesJob*)data;
+    for (u32 row = first; row < last; ++row) { job->lifetimes[row] -= job->delta; }
+}
+
+// Count down the lifetimes and destroy the entities whose time is up.
+// The count down is split into jobs. Removing moves rows around, so it runs on this thread once they are done
+void GameUpdateLifetimes(void) {
+    EcsComponentMask mask = EcsComponentBit(COMPONENT_LIFETIME);
+    GameLifetimesJob archetype_jobs[ECS_MAX_ARCHETYPES];  // One per archetype
+    JobCounter counter = {0};
+
+    ForEachEcsArchetype(&state->world, mask, iter) {
+        GameLifetimesJob* job = &archetype_jobs[iter.index];
+        *job = (GameLifetimesJob){.lifetimes = EcsColumn(iter.archetype, COMPONENT_LIFETIME, Lifetime), .delta = state->time_delta_simulation};
+        JobSystemParallelFor(&state->jobs, iter.archetype->count, GAME_JOB_ROWS, _GameLifetimesJob, job, &counter);
     }
+
+    JobSystemWait(&state->jobs, &counter);
+
+    ForEachEcsArchetype(&state->world, mask, iter) {
+        const Lifetime* lifetimes = EcsColumn(iter.archetype, COMPONENT_LIFETIME, Lifetime);
+
+        // Backwards, so the rows moved over the removed ones were already checked
+        for (u32 row = iter.archetype->count; row-- > 0;) {
+            if (lifetimes[row] <= 0) { EcsArchetypeRemove(&state->world, iter.archetype, row); }
+        }
+    }
+}
+
+// Set the kind of collision event of every pair of layers that interact
+void GameSetupCollisions(void) {
+    CollisionWorld* world = &state->collision_world;
+    CollisionWorldEventSet(world, GAME_COLLISION_LAYER_PROJECTILE_ENEMY, GAME_COLLISION_LAYER_PLAYER, GAME_COLLISION_EVENT_PROJECTILE_HITS_PLAYER);
+    CollisionWorldEventSet(world, GAME_COLLISION_LAYER_PROJECTILE_PLAYER, GAME_COLLISION_LAYER_ENEMY, GAME_COLLISION_EVENT_PROJECTILE_HITS_ENEMY);
+}
+
+// Bounding circle of an entity for the collision checks
+#define _GameCollisionWorldAdd(world, entity, id, layer, mask) \
+    CollisionWorldAdd((world), EntityBoundingCircleCenter(entity), (entity).bounding_circle.radius, (id), (layer), (mask))
+
+// Bounding circles of the entities with a collider, identified by their entity handles.
+// The ones with a velocity are swept along their movement of the last step so they can not tunnel through other entities
+void _GameCollisionWorldAddColliders(CollisionWorld* world) {
+    ForEachEcsArchetype(&state->world, EcsComponentBit(COMPONENT_POSITION) | EcsComponentBit(COMPONENT_COLLIDER), iter) {
+        const Position* positions = EcsColumn(iter.archetype, COMPONENT_POSITION, Position);
+        const Collider* colliders = EcsColumn(iter.archetype, COMPONENT_COLLIDER, Collider);
+        const Velocity* velocities = iter.archetype->mask & EcsComponentBit(COMPONENT_VELOCITY) ? EcsColumn(iter.archetype, COMPONENT_VELOCITY, Velocity) : NULL;
+
+        for (u32 row = 0; row < iter.archetype->count; ++row) {
+            Vector2 end = Vector2Add(positions[row], colliders[row].offset);
+            Vector2 start = velocities != NULL ? Vector2Subtract(end, Vector2ScaleToDelta(velocities[row])) : end;
+            CollisionWorldAddSwept(world, start, end, colliders[row].radius, iter.archetype->entities[row].handle, colliders[row].layer, colliders[row].mask);
+        }
+    }
+}
+
+// Compute the world-space bounding circles of the frame once, after all the movement
+void GameUpdateCollisionCircles(void) {
+    CollisionWorld* world = &state->collision_world;
+    u32 capacity = GAME_STATE_MAX_PLAYERS;
+    ForEachEcsArchetype(&state->world, EcsComponentBit(COMPONENT_COLLIDER), iter) { capacity += iter.archetype->count; }
+    CollisionWorldBegin(world, GameStateFrameArena(), capacity, max(state->world.record_count, GAME_STATE_MAX_PLAYERS));  // Entity records and player indices
+
+    ForEachPlayerVal(iter) { _GameCollisionWorldAdd(world, iter.player.entity, iter.index, GAME_COLLISION_LAYER_PLAYER, GAME_COLLISION_MASK_PLAYER); }
+    _GameCollisionWorldAddColliders(world);
 }
 
 // Game collision checking
 void GameCheckCollisions(void) {
-    ObjectPool *enemies = &state->enemies, *projectiles_enemies = &state->projectiles_enemies, *projectiles_players = &state->projectiles_players;
-
-    ForEachObjectPoolObject(projectiles_enemies, Projectile, iter_projectile) {
-        bool collided = false;
-        Projectile projectile = *iter_projectile.object;
-        ForEachPlayerRef(iter_player) {
-            Player* player = iter_player.player;
-            if (CheckEntityCollision(player->entity, projectile.entity)) {
-                PlayerDamage(player, projectile.damage);
-                collided = true;
-            }
-        }
-        if (collided) { ObjectPoolObjectRemove(projectiles_enemies, iter_projectile.index); }
+    Arena* arena = GameStateFrameArena();
+    CollisionWorld* world = &state->collision_world;
+
+    // Detection, without side effects
+    CollisionWorldUpdate(world, arena);
+    CollisionEvents events = CollisionWorldEvents(world, arena);
+
+    GameResolveCollisions(events, arena);
+}
+
+// Apply the collision events of the frame. Damage is added up per entity and applied once, then dead entities and spent projectiles are destroyed.
+// Circles hold entity handles, so destroying an entity does not invalidate the rest
+void GameResolveCollisions(CollisionEvents events, Arena* arena) {
+    EcsWorld* world = &state->world;
+    CollisionCircles circles = state->collision_world.circles;
+    u32* damage = ArenaPushArrayZero(arena, u32, circles.count);   // Damage taken by each circle
+    bool* spent = ArenaPushArrayZero(arena, bool, circles.count);  // Projectiles that hit something
+
+    ForEachCollisionEvent(events, GAME_COLLISION_EVENT_PROJECTILE_HITS_PLAYER, event) {
+        damage[event->b] += *EcsEntityComponentType(world, (EcsEntity){circles.ids[event->a]}, COMPONENT_DAMAGE, Damage);
+        spent[event->a] = true;
+    }
+    ForEachCollisionEvent(events, GAME_COLLISION_EVENT_PROJECTILE_HITS_ENEMY, event) {
+        damage[event->b] += *EcsEntityComponentType(world, (EcsEntity){circles.ids[event->a]}, COMPONENT_DAMAGE, Damage);
+        spent[event->a] = true;
     }
 
-    ForEachObjectPoolObject(projectiles_players, Projectile, iter_projectile) {
-        bool collided = false;
-        Projectile projectile = *iter_projectile.object;
-        ForEachObjectPoolObject(enemies, Enemy, iter_enemy) {
-            Enemy* enemy = iter_enemy.object;
-            if (CheckEntityCollision(enemy->entity, projectile.entity)) {
-                if (EnemyDamage(enemy, projectile.damage)) { ObjectPoolObjectRemove(enemies, iter_enemy.index); }
-                collided = true;
-            }
+    for (u32 i = 0; i < circles.count; ++i) {
+        EcsEntity entity = {circles.ids[i]};
+        switch (circles.layers[i]) {
+            case GAME_COLLISION_LAYER_PLAYER:
+                if (damage[i] > 0) { PlayerDamage(&state->players[circles.ids[i]], damage[i]); }
+                break;
+            case GAME_COLLISION_LAYER_ENEMY:
+                if (damage[i] > 0 && EnemyDamage(entity, damage[i])) { EcsEntityDestroy(world, entity); }
+                break;
+            case GAME_COLLISION_LAYER_PROJECTILE_PLAYER:
+            case GAME_COLLISION_LAYER_PROJECTILE_ENEMY:
+                if (spent[i]) { EcsEntityDestroy(world, entity); }
+                break;
         }
-        if (collided) { ObjectPoolObjectRemove(projectiles_players, iter_projectile.index); }
     }
 }
 
@@ -98,7 +247,8 @@ void GameCheckCollisions(void) {
 
 // Generate enemies around the player
 void GameDebugGenerateEnemiesAroundPlayer(void) {
-    ForEachObjectPoolObject(&state->enemies, Enemy, iter) { ObjectPoolObjectRemove(&state->enemies, iter.index); }  // Might remove later on
+    EcsArchetype* enemies = EcsArchetypeFind(&state->world, ARCHETYPE_ENEMY);
+    if (enemies != NULL) { EcsArchetypeClear(&state->world, enemies); }  // Might remove later on
 
 #define ENEMIES_CREATED_AT_START         4
 #define ENEMIES_CREATED_AT_START_SPACING 400
@@ -106,11 +256,70 @@ void GameDebugGenerateEnemiesAroundPlayer(void) {
     Vector2 player_center = EntityCenter(state->players[0].entity);
 
     for (u32 i = 0; i < ENEMIES_CREATED_AT_START; ++i) {
-        f32 rotation = Deg2Rad(GetRandomValue(0, MAX_DEGS));
+        f32 rotation = Deg2Rad(RandomValue(&state->random, 0, MAX_DEGS));
         Vector2 pos = Vector2Add(player_center, Vector2Scale(Vector2UnitCirclePoint(rotation), ENEMIES_CREATED_AT_START_SPACING));
 
-        EnemyCreate(
-            i & 1 ? SPACESHIP_ENEMY_UPGRADED : SPACESHIP_ENEMY_BASE, pos, ENEMY_MOVEMENT_SPEED, Vector2AngleFromXAxis(Vector2Subtract(player_center, pos)));
+        EnemyCreate(i & 1 ? SPACESHIP_ENEMY_UPGRADED : SPACESHIP_ENEMY_BASE, pos, Vector2AngleFromXAxis(Vector2Subtract(player_center, pos)));
+    }
+}
+
+#define COLLISIONS_STRESS_ENTITIES       10000
+#define COLLISIONS_STRESS_AREA_SIZE      6000
+#define COLLISIONS_STRESS_CLUSTERS_SIDE  4    // Clusters per side of the area
+#define COLLISIONS_STRESS_CLUSTER_RADIUS 250
+#define COLLISIONS_STRESS_LINE_LENGTH    24000
+#define COLLISIONS_STRESS_LINE_WIDTH     150
+
+// Position of an entity of the collisions stress scenario.
+// Every random value is taken on its own statement, as the evaluation order of the arguments of a call is unspecified
+Vector2 _GameDebugCollisionsStressPosition(Vector2 center, u32 index) {
+    Random* random = &state->random;
+    switch (state->testing_stress_layout) {
+        case TESTING_STRESS_LAYOUT_CLUSTERED: {
+            u32 cluster = index % (COLLISIONS_STRESS_CLUSTERS_SIDE * COLLISIONS_STRESS_CLUSTERS_SIDE);
+            f32 spacing = COLLISIONS_STRESS_AREA_SIZE / (f32)COLLISIONS_STRESS_CLUSTERS_SIDE;
+            Vector2 cluster_center = Vector2From((cluster % COLLISIONS_STRESS_CLUSTERS_SIDE + 0.5f) * spacing - COLLISIONS_STRESS_AREA_SIZE * 0.5f,
+                                                 (cluster / COLLISIONS_STRESS_CLUSTERS_SIDE + 0.5f) * spacing - COLLISIONS_STRESS_AREA_SIZE * 0.5f);
+            f32 rotation = Deg2Rad(RandomValue(random, 0, MAX_DEGS));
+            f32 distance = COLLISIONS_STRESS_CLUSTER_RADIUS * (RandomValue(random, 0, 1000) * RandomValue(random, 0, 1000)) / 1000000.f;  // Denser at the center
+            return Vector2Add(Vector2Add(center, cluster_center), Vector2Scale(Vector2UnitCirclePoint(rotation), distance));
+        }
+        case TESTING_STRESS_LAYOUT_LINE: {
+            f32 x = RandomValue(random, -COLLISIONS_STRESS_LINE_LENGTH / 2, COLLISIONS_STRESS_LINE_LENGTH / 2);
+            f32 y = RandomValue(random, -COLLISIONS_STRESS_LINE_WIDTH / 2, COLLISIONS_STRESS_LINE_WIDTH / 2);
+            return Vector2Add(center, Vector2From(x, y));
+        }
+        case TESTING_STRESS_LAYOUT_UNIFORM:
+        default: {
+            f32 x = RandomValue(random, -COLLISIONS_STRESS_AREA_SIZE / 2, COLLISIONS_STRESS_AREA_SIZE / 2);
+            f32 y = RandomValue(random, -COLLISIONS_STRESS_AREA_SIZE / 2, COLLISIONS_STRESS_AREA_SIZE / 2);
+            return Vector2Add(center, Vector2From(x, y));
+        }
+    }
+}
+
+// Spawn a crowd of enemies and player projectiles around the player to stress the collision checks
+void GameDebugGenerateCollisionsStress(void) {
+    Vector2 center = EntityCenter(state->players[0].entity);
+    bool line = state->testing_stress_layout == TESTING_STRESS_LAYOUT_LINE;
+
+    for (u32 i = 0; i < COLLISIONS_STRESS_ENTITIES; ++i) {
+        Vector2 pos = _GameDebugCollisionsStressPosition(center, i);
+        f32 rotation = Deg2Rad(RandomValue(&state->random, 0, MAX_DEGS));
+        EnemyCreate(SPACESHIP_ENEMY_BASE, pos, rotation);
+    }
+
+    for (u32 i = 0; i < COLLISIONS_STRESS_ENTITIES; ++i) {
+        Vector2 pos = _GameDebugCollisionsStressPosition(center, i);
+        f32 rotation = line ? Deg2Rad(RandomValue(&state->random, -5, 5)) : Deg2Rad(RandomValue(&state->random, 0, MAX_DEGS));
+        ProjectileCreate(PROYECTILE_PLAYER,
+                         pos,
+                         PROJECTILE_BASIC_SIZE,
+                         PROJECTILE_BASIC_SPEED,
+                         rotation,
+                         PROJECTILE_BASIC_BOUNDING_CIRCLE(rotation),
+                         PLAYER_ABILITY_SHOOT_DAMAGE,
+                         PLAYER_ABILITY_SHOOT_RANGE);
     }
 }
 
@@ -120,7 +329,7 @@ void TestingInput(void) {
     if (IsKeyPressed(KEY_ZERO)) { state->time_running = !state->time_running; }
 
     // Generate random enemies around player 0
-    if (IsKeyPressed(KEY_ONE)) { GameDebugGenerateEnemiesAroundPlayer(); }
+    if (IsKeyPressed(KEY_ONE)) { state->testing_commands |= TESTING_COMMAND_ENEMIES_AROUND_PLAYER; }
 
     // Toggle bounding circles
     if (IsKeyPressed(KEY_TWO)) { state->testing_draw_bounding_circles = !state->testing_draw_bounding_circles; }
@@ -128,6 +337,15 @@ void TestingInput(void) {
     // Toggle player rotation
     if (IsKeyPressed(KEY_THREE)) { state->testing_draw_player_rotation = !state->testing_draw_player_rotation; }
 
+    // Switch collision broadphase
+    if (IsKeyPressed(KEY_FOUR)) { state->collision_world.broadphase = (state->collision_world.broadphase + 1) % COLLISION_BROADPHASE_COUNT; }
+
+    // Generate collisions stress scenario
+    if (IsKeyPressed(KEY_FIVE)) { state->testing_commands |= TESTING_COMMAND_COLLISIONS_STRESS; }
+
+    // Switch collisions stress scenario layout
+    if (IsKeyPressed(KEY_SIX)) { state->testing_stress_layout = (state->testing_stress_layout + 1) % TESTING_STRESS_LAYOUT_COUNT; }
+
     // Toggle maximized window
     if (IsKeyPressed(KEY_SEVEN)) { MaximizeWindow(); }
 
@@ -146,4 +364,11 @@ void TestingInput(void) {
     }
 }
 
+// Testing inputs queued for the tick that change the simulation
+void TestingCommands(void) {
+    if (state->testing_commands & TESTING_COMMAND_ENEMIES_AROUND_PLAYER) { GameDebugGenerateEnemiesAroundPlayer(); }
+    if (state->testing_commands & TESTING_COMMAND_COLLISIONS_STRESS) { GameDebugGenerateCollisionsStress(); }
+    state->testing_commands = 0;
+}
+
 #endif  // TESTING
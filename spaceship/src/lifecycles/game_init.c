@@ -12,19 +12,23 @@
 
 void GameSetupWindow(void);
 void GameInitializeEntities(void);
+void GameSetupCollisions(void);
 
 // Game initialization
-void GameInitialize(void) {
-    SetRandomSeed((u32)(time(NULL) % UINT_MAX));
+void GameInitialize(void) { GameInitializeReplay(GameReplayCreate(GAME_REPLAY_MODE_LIVE, (u64)time(NULL))); }
 
+// Game initialization, seeded and with the input recorded or played by a replay
+void GameInitializeReplay(GameReplay replay) {
     GameSetupWindow();
-    GameStateInitialize();
+    GameStateInitialize(replay);
+    GameSetupCollisions();
 
 #ifdef DEBUG
     GameDebugInitialize();
 #endif
 
     GameInitializeEntities();
+    GameReplayStart(&state->replay);
 }
 
 // Window setup
@@ -2,12 +2,18 @@
 #ifndef ENGINE_H
 #define ENGINE_H
 
+#include "lifecycles/game_replay.h"
 #include "types/types.h"
 
 /**
  * Initialize of the game.
  */
 void GameInitialize(void);
+/**
+ * Initialize of the game in deterministic mode. The simulation is seeded by the replay, and its input is recorded or played by it.
+ * @param replay Replay of the session. Owned by the game state from then on.
+ */
+void GameInitializeReplay(GameReplay replay);
 /**
  * Loop where all the game logic is executed.
  */
@@ -20,6 +26,10 @@ bool GameShouldClose(void);
  * Calculations that need to be done every frame.
  */
 void GameFrame(void);
+/**
+ * Fixed step of the simulation, run by `GameFrame` as many times as the time of the frame needs.
+ */
+void GameTick(void);
 /**
  * Object drawing.
  */
@@ -1,4 +1,5 @@
 #include "lifecycles/game_lifecycle.h"
+#include "lifecycles/game_state.h"
 #include "raylib/raylib.h"
 
 // Check if the game should end
@@ -8,6 +9,8 @@ bool GameShouldClose(void) { return WindowShouldClose(); }
 void GameLoop(void) {
     while (!GameShouldClose())  // Detect window close button or defined exit key
     {
+        GameStateFrameArenaSwap();
+
         GameFrame();
         GameDraw();
     }
@@ -0,0 +1,243 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "lifecycles/game_replay.h"
+#include "lifecycles/game_state.h"
+#include "utils/memory_utils.h"
+#include "types/types.h"
+
+_Static_assert(ACTION_TYPES_COUNT <= 16, "The changed actions of a player are stored as the bits of a u16");
+
+// Header of a replay file. Sized without padding bytes
+typedef struct GameReplayHeader {
+    u32 magic;
+    u16 version;
+    u8 action_count;
+    u8 player_count;
+    u64 seed;
+    u16 screen_width;
+    u16 screen_height;
+    u32 _reserved;
+    u64 tick_count;
+} GameReplayHeader;
+
+GameReplay GameReplayCreate(GameReplayMode mode, u64 seed) { return (GameReplay){.mode = mode, .seed = seed}; }
+
+bool GameReplayLoad(GameReplay* replay, const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) { return false; }
+
+    GameReplayHeader header;
+    bool valid = fread(&header, sizeof(GameReplayHeader), 1, file) == 1 && header.magic == GAME_REPLAY_MAGIC && header.version == GAME_REPLAY_VERSION &&
+                 header.action_count == ACTION_TYPES_COUNT && header.player_count <= GAME_REPLAY_MAX_PLAYERS;
+
+    // The rest of the file are the records of the ticks
+    long log_size = 0;
+    if (valid && fseek(file, 0, SEEK_END) == 0 && (log_size = ftell(file)) >= (long)sizeof(GameReplayHeader) &&
+        fseek(file, sizeof(GameReplayHeader), SEEK_SET) == 0) {
+        log_size -= sizeof(GameReplayHeader);
+    } else {
+        valid = false;
+    }
+
+    if (valid) {
+        *replay = (GameReplay){
+            .mode = GAME_REPLAY_MODE_PLAY,
+            .seed = header.seed,
+            .screen_width = header.screen_width,
+            .screen_height = header.screen_height,
+            .player_count = header.player_count,
+            .log = (byte*)malloc(max(log_size, 1)),
+            .log_size = log_size,
+            .log_capacity = log_size,
+            .tick_count = header.tick_count,
+        };
+        valid = fread(replay->log, 1, log_size, file) == (usize)log_size;
+        if (!valid) { GameReplayDelete(replay); }
+    }
+
+    fclose(file);
+    return valid;
+}
+
+bool GameReplaySave(const GameReplay* replay, const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) { return false; }
+
+    GameReplayHeader header = {
+        .magic = GAME_REPLAY_MAGIC,
+        .version = GAME_REPLAY_VERSION,
+        .action_count = ACTION_TYPES_COUNT,
+        .player_count = replay->player_count,
+        .seed = replay->seed,
+        .screen_width = replay->screen_width,
+        .screen_height = replay->screen_height,
+        ._reserved = 0,
+        .tick_count = replay->tick_count,
+    };
+    bool written = fwrite(&header, sizeof(GameReplayHeader), 1, file) == 1 && fwrite(replay->log, 1, replay->log_size, file) == replay->log_size;
+
+    return fclose(file) == 0 && written;
+}
+
+void GameReplayDelete(GameReplay* replay) {
+    free(replay->log);
+    *replay = (GameReplay){0};
+}
+
+// ---- Log -------------------------------------------------------------------
+
+void _GameReplayWrite(GameReplay* replay, const void* data, usize size) {
+    if (replay->log_size + size > replay->log_capacity) {
+        replay->log_capacity = max(max(replay->log_capacity * 2, replay->log_size + size), GAME_REPLAY_LOG_MIN);
+        replay->log = (byte*)realloc(replay->log, replay->log_capacity);
+    }
+    memory_copy(replay->log + replay->log_size, data, size);
+    replay->log_size += size;
+}
+
+bool _GameReplayRead(GameReplay* replay, void* data, usize size) {
+    if (replay->log_cursor + size > replay->log_size) { return false; }
+    memory_copy(data, replay->log + replay->log_cursor, size);
+    replay->log_cursor += size;
+    return true;
+}
+
+// Marks the first tick whose state does not match the log
+void _GameReplayDiverge(GameReplay* replay) {
+    if (!replay->diverged) {
+        replay->diverged = true;
+        replay->diverged_tick = state->time_ticks;
+    }
+}
+
+// Stops playing the log, handing the input back to the devices
+void _GameReplayFinish(GameReplay* replay) { replay->mode = GAME_REPLAY_MODE_LIVE; }
+
+// Log cut in the middle of a record
+void _GameReplayTruncated(GameReplay* replay) {
+    _GameReplayDiverge(replay);
+    _GameReplayFinish(replay);
+}
+
+// Bitwise, so -0 and NaN values are logged as they were read
+bool _GameReplayActionChanged(f32 a, f32 b) {
+    u32 a_bits, b_bits;
+    memory_copy(&a_bits, &a, sizeof(u32));
+    memory_copy(&b_bits, &b, sizeof(u32));
+    return a_bits != b_bits;
+}
+
+// ---- Ticks -----------------------------------------------------------------
+
+void GameReplayStart(GameReplay* replay) {
+    u32 players = 0;
+    ForEachPlayerRef(iter) {
+        (void)iter;
+        ++players;
+    }
+
+    if (replay->mode != GAME_REPLAY_MODE_PLAY) {
+        replay->player_count = min(players, GAME_REPLAY_MAX_PLAYERS);
+    } else if (players != replay->player_count) {
+        _GameReplayTruncated(replay);  // Recorded with other players, so no input would match
+    }
+}
+
+void _GameReplayRecordInput(GameReplay* replay) {
+    u8 commands = state->testing_commands;
+    _GameReplayWrite(replay, &commands, sizeof(u8));
+    if (commands & TESTING_COMMAND_COLLISIONS_STRESS) {
+        u8 layout = (u8)state->testing_stress_layout;
+        _GameReplayWrite(replay, &layout, sizeof(u8));
+    }
+
+    ForEachPlayerRef(iter) {
+        if (iter.index >= replay->player_count) { break; }
+
+        f32* logged = replay->actions[iter.index];
+        const f32* actions = iter.player->_actions;
+
+        u16 changed = 0;
+        for (u32 a = 0; a < ACTION_TYPES_COUNT; ++a) {
+            if (_GameReplayActionChanged(actions[a], logged[a])) { changed |= 1 << a; }
+        }
+
+        _GameReplayWrite(replay, &changed, sizeof(u16));
+        for (u32 a = 0; a < ACTION_TYPES_COUNT; ++a) {
+            if (changed & (1 << a)) {
+                _GameReplayWrite(replay, &actions[a], sizeof(f32));
+                logged[a] = actions[a];
+            }
+        }
+    }
+}
+
+void _GameReplayPlayInput(GameReplay* replay) {
+    u8 commands;
+    u8 layout;
+    if (!_GameReplayRead(replay, &commands, sizeof(u8))) {
+        _GameReplayTruncated(replay);
+        return;
+    }
+    if (commands & TESTING_COMMAND_COLLISIONS_STRESS) {
+        if (!_GameReplayRead(replay, &layout, sizeof(u8))) {
+            _GameReplayTruncated(replay);
+            return;
+        }
+        state->testing_stress_layout = layout;
+    }
+    state->testing_commands = commands;
+
+    ForEachPlayerRef(iter) {
+        if (iter.index >= replay->player_count) { break; }
+
+        f32* logged = replay->actions[iter.index];
+
+        u16 changed;
+        if (!_GameReplayRead(replay, &changed, sizeof(u16))) {
+            _GameReplayTruncated(replay);
+            return;
+        }
+        for (u32 a = 0; a < ACTION_TYPES_COUNT; ++a) {
+            if ((changed & (1 << a)) && !_GameReplayRead(replay, &logged[a], sizeof(f32))) {
+                _GameReplayTruncated(replay);
+                return;
+            }
+        }
+
+        memory_copy(iter.player->_actions, logged, sizeof(f32) * ACTION_TYPES_COUNT);
+    }
+}
+
+void GameReplayTickInput(GameReplay* replay) {
+    if (replay->mode == GAME_REPLAY_MODE_PLAY && replay->log_cursor >= replay->log_size) { _GameReplayFinish(replay); }
+
+    if (replay->mode == GAME_REPLAY_MODE_PLAY) {
+        _GameReplayPlayInput(replay);
+        if (replay->mode == GAME_REPLAY_MODE_PLAY) { return; }
+    }
+
+    ForEachPlayerRef(iter) { PlayerSampleActions(iter.player); }
+
+    if (replay->mode == GAME_REPLAY_MODE_RECORD) { _GameReplayRecordInput(replay); }
+}
+
+void GameReplayTickEnd(GameReplay* replay) {
+    if (replay->mode == GAME_REPLAY_MODE_LIVE) { return; }
+
+    u64 state_hash = GameStateHash();
+    u32 hash = (u32)(state_hash ^ (state_hash >> 32));
+
+    if (replay->mode == GAME_REPLAY_MODE_RECORD) {
+        _GameReplayWrite(replay, &hash, sizeof(u32));
+        ++replay->tick_count;
+    } else {
+        u32 logged;
+        if (!_GameReplayRead(replay, &logged, sizeof(u32))) {
+            _GameReplayTruncated(replay);
+            return;
+        }
+        if (logged != hash) { _GameReplayDiverge(replay); }
+    }
+}
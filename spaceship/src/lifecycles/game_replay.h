@@ -0,0 +1,94 @@
+#pragma once
+#ifndef GAME_REPLAY_H
+#define GAME_REPLAY_H
+
+#include "control/actions.h"
+#include "types/types.h"
+
+// ----------------------------------------------------------------------------
+// ---- Game replay -----------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+// The simulation only depends on its seed and on the input of every tick, so a session is stored as a log of those inputs.
+// The log is a header followed by one record per tick:
+// - `u8` Testing commands of the tick, followed by the `u8` stress layout when a collisions stress test is spawned.
+// - For every player: a `u16` with a bit for every action whose value changed, followed by the new `f32` values.
+// - `u32` Hash of the state at the end of the tick, to check the replay follows the recorded session.
+// Values are stored in the byte order of the machine.
+
+#define GAME_REPLAY_MAGIC       0x5052564E  // "NVRP"
+#define GAME_REPLAY_VERSION     3            // Increased whenever the log or the state hash changes
+#define GAME_REPLAY_MAX_PLAYERS 4            // Players whose actions fit on a log
+#define GAME_REPLAY_LOG_MIN     (16 * 1024)  // Initial bytes of the log of a recording
+
+typedef enum GameReplayMode {
+    GAME_REPLAY_MODE_LIVE = 0,  // Input read from the devices and not stored
+    GAME_REPLAY_MODE_RECORD,    // Input read from the devices and stored on the log
+    GAME_REPLAY_MODE_PLAY,      // Input read from the log. Turns to live once the log ends
+} GameReplayMode;
+
+typedef struct GameReplay {
+    GameReplayMode mode;
+    u64 seed;           // Seed of the simulation
+    u16 screen_width;   // Width of the screen the players spawned on, so they spawn at the same place on any window
+    u16 screen_height;  // Height of the screen the players spawned on
+    u8 player_count;    // Players whose actions are stored on every tick
+
+    byte* log;  // Records of the ticks
+    usize log_size;
+    usize log_capacity;
+    usize log_cursor;  // Next byte to read while playing
+    u64 tick_count;    // Ticks stored on the log
+
+    f32 actions[GAME_REPLAY_MAX_PLAYERS][ACTION_TYPES_COUNT];  // Last stored values, only the changes are logged
+
+    bool diverged;      // Some state did not match the log
+    u64 diverged_tick;  // First tick whose state did not match the log
+} GameReplay;
+
+/**
+ * Creates a replay of a new session.
+ * @param mode `GAME_REPLAY_MODE_LIVE` to just seed the simulation, or `GAME_REPLAY_MODE_RECORD` to also store its input.
+ * @param seed Seed of the simulation.
+ * @return New replay.
+ */
+GameReplay GameReplayCreate(GameReplayMode mode, u64 seed);
+/**
+ * Loads a recorded session to play it.
+ * @param replay Where to load the replay.
+ * @param path File of the replay.
+ * @return True if the file is a valid replay.
+ */
+bool GameReplayLoad(GameReplay* replay, const char* path);
+/**
+ * Saves the session recorded so far.
+ * @param replay Replay to save.
+ * @param path File to write.
+ * @return True if the file was written.
+ */
+bool GameReplaySave(const GameReplay* replay, const char* path);
+/**
+ * Deletes the memory of a replay.
+ * @param replay Replay to delete.
+ */
+void GameReplayDelete(GameReplay* replay);
+
+/**
+ * Starts the replay of the game state once its players were added.
+ * @param replay Replay of the game state.
+ */
+void GameReplayStart(GameReplay* replay);
+/**
+ * Sets the input of the tick: the actions of the players are read from the devices, and stored while recording,
+ * or read from the log while playing. Call at the start of every tick, before anything reads the actions.
+ * @param replay Replay of the game state.
+ */
+void GameReplayTickInput(GameReplay* replay);
+/**
+ * Stores the hash of the state while recording, or checks it against the stored one while playing.
+ * Call at the end of every tick.
+ * @param replay Replay of the game state.
+ */
+void GameReplayTickEnd(GameReplay* replay);
+
+#endif  // GAME_REPLAY_H
@@ -12,8 +12,14 @@
 
 GameState* state = NULL;
 
-void GameStateInitialize(void) {
-    if (state == NULL) { state = reserve(GameState); }
+void GameStateInitialize(GameReplay replay) {
+    if (state == NULL) { state = reserve_aligned_t(GameState); }  // The job queues are aligned to cache lines, more than malloc guarantees
+
+    // Players spawn at the center of the screen of the recorded session
+    if (replay.mode != GAME_REPLAY_MODE_PLAY) {
+        replay.screen_width = GetScreenWidth();
+        replay.screen_height = GetScreenHeight();
+    }
 
     Image spritesheet_image = LoadImage(path_image("spritesheet.png"));
 
@@ -21,19 +27,27 @@ void GameStateInitialize(void) {
         .time_elapsed = 0,
         .time_delta_real = 0,
         .time_speed_magnitude = 0,
-        .time_delta_simulation = 0,
+        .time_delta_simulation = GAME_STATE_TICK_DELTA,
         .time_running = true,
+        .time_accumulator = 0,
+        .time_alpha = 0,
+        .time_ticks = 0,
+        .time_frame_ticks = 0,
 
-        .player_count = 0,  // No players for now
-        .players = {0},     // All non-initialized
-        .game_over = {0},   // All false
+        .random = RandomCreate(replay.seed),
+        .replay = replay,
 
-        .mappings = {0},        // All non-initialized
+        .player_count = 0,      // No players for now
+        .game_over = {0},       // All false
         .gamepad_locked = {0},  // All gamepads free to use
 
-        .enemies = ObjectPoolCreateType(Enemy),
-        .projectiles_players = ObjectPoolCreateType(Projectile),
-        .projectiles_enemies = ObjectPoolCreateType(Projectile),
+        .world = EcsWorldCreate(GAME_COMPONENT_SIZES, COMPONENT_COUNT),
+
+        .collision_world = CollisionWorldCreate(COLLISION_BROADPHASE_GRID, &state->jobs),
+        .stage_times = {0},
+
+        .frame_arenas = {ArenaCreateCustom(GAME_STATE_FRAME_ARENA_SIZE), ArenaCreateCustom(GAME_STATE_FRAME_ARENA_SIZE)},
+        .frame_arena_current = 0,
 
         .spritesheet = LoadTextureFromImage(spritesheet_image),
         .spritesheet_locations_spaceships = {TEXTURE_POS_SPACESHIP_FRIENDLY_BASE,
@@ -51,48 +65,132 @@ void GameStateInitialize(void) {
         .testing_draw_bounding_circles = false,
         .testing_draw_player_rotation = false,
 #endif
+        .testing_stress_layout = TESTING_STRESS_LAYOUT_UNIFORM,
+        .testing_commands = 0,
     };
 
     UnloadImage(spritesheet_image);
 
-    // Set mappings
-    for (InputDevice device = 0; device <= INPUT_DEVICE_MOUSE_AND_KEYBOARD; ++device) { GameStateSetDefaultMappings(device); }
+    JobSystemStart(&state->jobs, 0);  // One worker per processor
 }
 
-void GameStateUpdate(void) {
-    f32 delta = GetFrameTime();
+u32 GameStateAdvanceTime(void) {
+    state->time_delta_real = GetFrameTime();
+    state->time_frame_ticks = 0;
+
+    if (!state->time_running) { return 0; }
 
-    state->time_delta_real = delta;
-    state->time_delta_simulation =
-        state->time_speed_magnitude == 0 ? state->time_delta_real : state->time_delta_real + (state->time_delta_real * state->time_speed_magnitude * 0.2f);
-    state->time_elapsed += state->time_delta_simulation;
+    // The game speed changes how fast time is fed to the ticks, never the length of a tick
+    state->time_accumulator += state->time_delta_real + (state->time_delta_real * state->time_speed_magnitude * 0.2f);
+
+    u32 ticks = (u32)(state->time_accumulator / GAME_STATE_TICK_DELTA);
+    if (ticks > GAME_STATE_MAX_TICKS_PER_FRAME) {
+        ticks = GAME_STATE_MAX_TICKS_PER_FRAME;
+        state->time_accumulator = ticks * GAME_STATE_TICK_DELTA;
+    }
+
+    state->time_accumulator -= ticks * GAME_STATE_TICK_DELTA;
+    state->time_alpha = state->time_accumulator / GAME_STATE_TICK_DELTA;
+    state->time_frame_ticks = ticks;
+    return ticks;
+}
+
+void GameStateUpdate(void) {
+    state->time_delta_simulation = GAME_STATE_TICK_DELTA;
+    state->time_elapsed += GAME_STATE_TICK_DELTA;
+    ++state->time_ticks;
 }
 
 void GameStateCleanup(void) {
     if (state != NULL) {
-        ObjectPoolDelete(&state->enemies);
-        ObjectPoolDelete(&state->projectiles_players);
-        ObjectPoolDelete(&state->projectiles_enemies);
+        ForEachPlayerRef(iter) { PlayerDelete(iter.player); }
+        GameReplayDelete(&state->replay);
+        EcsWorldDelete(&state->world);
+        CollisionWorldDelete(&state->collision_world);
+        JobSystemStop(&state->jobs);
+        ArenaDelete(&state->frame_arenas[0]);
+        ArenaDelete(&state->frame_arenas[1]);
         UnloadTexture(state->spritesheet);
         UnloadFont(state->font);
-        free(state);
+        free_aligned(state);
         state = NULL;
     }
 }
 
+// Components hashed as raw bytes. The ones with padding are hashed field by field, as their padding bytes are never initialized
+#define GAME_STATE_HASHED_COMPONENTS                                                                                 \
+    (EcsComponentBit(COMPONENT_POSITION) | EcsComponentBit(COMPONENT_VELOCITY) | EcsComponentBit(COMPONENT_HEALTH) | \
+     EcsComponentBit(COMPONENT_SPRITE) | EcsComponentBit(COMPONENT_LIFETIME) | EcsComponentBit(COMPONENT_DAMAGE))
+
+u64 _GameStateHashColliders(u64 hash, const EcsArchetype* archetype) {
+    const Collider* colliders = EcsColumn(archetype, COMPONENT_COLLIDER, Collider);
+    for (u32 row = 0; row < archetype->count; ++row) {
+        hash = HashValue(hash, colliders[row].offset);
+        hash = HashValue(hash, colliders[row].radius);
+        hash = HashValue(hash, colliders[row].layer);
+        hash = HashValue(hash, colliders[row].mask);
+    }
+    return hash;
+}
+
+u64 _GameStateHashCooldowns(u64 hash, const EcsArchetype* archetype) {
+    const Cooldown* cooldowns = EcsColumn(archetype, COMPONENT_COOLDOWN, Cooldown);
+    for (u32 row = 0; row < archetype->count; ++row) {
+        hash = HashValue(hash, cooldowns[row].down_time);
+        hash = HashValue(hash, cooldowns[row].available_at);
+    }
+    return hash;
+}
+
+u64 GameStateHash(void) {
+    u64 hash = HASH_INITIAL;
+    hash = HashValue(hash, state->time_ticks);
+    hash = HashValue(hash, state->time_elapsed);
+    hash = HashValue(hash, state->random.state);
+
+    ForEachPlayerVal(iter) {
+        Player player = iter.player;
+        hash = HashValue(hash, player.entity.position);
+        hash = HashValue(hash, player.entity.velocity);
+        hash = HashValue(hash, player.entity.rotation);
+        hash = HashValue(hash, player.health);
+        hash = HashValue(hash, player.ability_shooting.cooldown.available_at);
+        hash = HashValue(hash, player.ability_missile.cooldown.available_at);
+    }
+
+    // Every entity, by archetype and row, so their order is also checked
+    ForEachEcsArchetype(&state->world, 0, iter) {
+        EcsArchetype* archetype = iter.archetype;
+        hash = HashValue(hash, archetype->mask);
+        hash = HashValue(hash, archetype->count);
+        hash = HashBytes(hash, archetype->entities, sizeof(EcsEntity) * archetype->count);
+
+        for (u32 c = 0; c < state->world.component_count; ++c) {
+            if (archetype->mask & GAME_STATE_HASHED_COMPONENTS & EcsComponentBit(c)) {
+                hash = HashBytes(hash, archetype->columns[c], state->world.component_sizes[c] * archetype->count);
+            }
+        }
+        if (archetype->mask & EcsComponentBit(COMPONENT_COLLIDER)) { hash = _GameStateHashColliders(hash, archetype); }
+        if (archetype->mask & EcsComponentBit(COMPONENT_COOLDOWN)) { hash = _GameStateHashCooldowns(hash, archetype); }
+    }
+
+    return hash;
+}
+
 bool GameStatePlayerAdd(void) {
     u8 count = state->player_count;
     if (count < GAME_STATE_MAX_PLAYERS) {
         // Prioritize gamepads, but set mouse and keyboard as default fallback
-        InputDevice device = INPUT_DEVICE_MOUSE_AND_KEYBOARD;
-        for (u8 i = 0; i < count; ++i) {
-            if (IsGamepadAvailable(i) && !state->gamepad_locked[i]) {
-                state->gamepad_locked[i] = true;
-                device = i;
+        InputDeviceID device = INPUT_DEVICE_ID_KEYBOARD_AND_MOUSE;
+        for (InputDeviceID gamepad = 0; gamepad < MAX_GAMEPADS; ++gamepad) {
+            if (IsGamepadAvailable(gamepad) && !state->gamepad_locked[gamepad]) {
+                state->gamepad_locked[gamepad] = true;
+                device = gamepad;
+                break;
             }
         }
 
-        state->players[count] = PlayerCreate(device, count, SPACESHIP_FRIENDLY_BASE, Vector2Scale(Vector2From(GetScreenWidth(), GetScreenHeight()), 0.5f));
+        state->players[count] = PlayerCreate(device, count, SPACESHIP_FRIENDLY_BASE, Vector2Scale(Vector2From(state->replay.screen_width, state->replay.screen_height), 0.5f));
         state->game_over[count] = false;
 
         ++state->player_count;
@@ -104,7 +202,9 @@ bool GameStatePlayerAdd(void) {
 bool GameStatePlayerRemove(void) {
     u8 count = state->player_count;
     if (count > 0) {
-        state->gamepad_locked[state->players[count]._device] = false;
+        Player* player = &state->players[count - 1];
+        if (player->_input.device >= 0) { state->gamepad_locked[player->_input.device] = false; }
+        PlayerDelete(player);
 
         --state->player_count;
         return true;
@@ -112,9 +212,20 @@ bool GameStatePlayerRemove(void) {
     return false;
 }
 
-bool GameStateIsGameOver() { return state->game_over; }
+bool GameStateIsGameOver() {
+    ForEachPlayerVal(iter) {
+        if (!state->game_over[iter.index]) { return false; }
+    }
+    return true;
+}
+
+void GameStateSetGameOver() {
+    ForEachPlayerVal(iter) { state->game_over[iter.index] = true; }
+}
+
+bool GameStateIsPlayerGameOver(Player player) { return state->game_over[player._player_index]; }
 
-void GameStateSetGameOver() { state->game_over = true; }
+void GameStateSetPlayerGameOver(Player* player) { state->game_over[player->_player_index] = true; }
 
 Player GameStateGetClosestPlayer(Vector2 position) {
     u8 closest = 0;
@@ -129,21 +240,32 @@ Player GameStateGetClosestPlayer(Vector2 position) {
     return state->players[closest];
 }
 
-#define _GameStateSetDefaultMappingsAgnostic(device, default_values)                                  \
-    do {                                                                                              \
-        Mapping default_mappings[ACTION_TYPES_COUNT] = default_values;                                \
-        memory_copy(state->mappings[device], default_mappings, sizeof(Mapping) * ACTION_TYPES_COUNT); \
-    } while (0)
-
-void GameStateSetDefaultMappings() {
-    InputMap device_mappings[] = ;
-    GreedyInputHandlerDeviceMappingsSet(&state->input_handler, device);
+void GameStateFrameArenaSwap(void) {
+    state->frame_arena_current ^= 1;
+    ArenaClear(&state->frame_arenas[state->frame_arena_current]);
 }
 
+Arena* GameStateFrameArena(void) { return &state->frame_arenas[state->frame_arena_current]; }
+
+Arena* GameStatePreviousFrameArena(void) { return &state->frame_arenas[state->frame_arena_current ^ 1]; }
+
 Rectangle SpaceshipTextureLocation(SpaceshipType type) { return state->spritesheet_locations_spaceships[type]; }
 
 Rectangle ProjectileTextureLocation(ProjectileType type) { return state->spritesheet_locations_proyectiles[type]; }
 
+const char* GameStageName(GameStage stage) {
+    switch (stage) {
+        case GAME_STAGE_PLAYERS: return "players";
+        case GAME_STAGE_MOVEMENT: return "movement";
+        case GAME_STAGE_LIFETIMES: return "lifetimes";
+        case GAME_STAGE_COLLISION_CIRCLES: return "circles";
+        case GAME_STAGE_COLLISIONS: return "collisions";
+        default: return "unknown";
+    }
+}
+
 f32 ScaleToDelta(f32 value) { return value * state->time_delta_simulation; }
 
 Vector2 Vector2ScaleToDelta(Vector2 v) { return Vector2Scale(v, state->time_delta_simulation); }
+
+Vector2 Vector2InterpolateTicks(Vector2 position, Vector2 step) { return Vector2Subtract(position, Vector2Scale(step, 1 - state->time_alpha)); }
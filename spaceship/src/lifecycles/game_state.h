@@ -2,9 +2,14 @@
 #ifndef __STATE_H__
 #define __STATE_H__
 
+#include "entities/collisions.h"
 #include "entities/entities.h"
 #include "input/input-handler.h"
-#include "types/object_pool.h"
+#include "lifecycles/game_replay.h"
+#include "types/arena.h"
+#include "types/ecs.h"
+#include "types/jobs.h"
+#include "utils/random.h"
 #include "raylib/config.h"
 #include "raylib/raylib.h"
 #include "types/types.h"
@@ -13,25 +18,81 @@
 // ---- Game state ------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
+typedef enum TestingStressLayout {
+    TESTING_STRESS_LAYOUT_UNIFORM = 0,  // Entities spread over a square
+    TESTING_STRESS_LAYOUT_CLUSTERED,    // Entities packed around a few points
+    TESTING_STRESS_LAYOUT_LINE,         // Entities along a long horizontal band, projectiles moving on the x axis
+    TESTING_STRESS_LAYOUT_COUNT,
+} TestingStressLayout;
+
+// Testing inputs that change the simulation. Queued by the testing input and run at the start of the next tick, so replays can store them
+typedef enum TestingCommand {
+    TESTING_COMMAND_ENEMIES_AROUND_PLAYER = 1 << 0,  // Enemies around the first player
+    TESTING_COMMAND_COLLISIONS_STRESS = 1 << 1,      // Collisions stress test, with the current stress layout
+} TestingCommand;
+
+typedef enum GameCollisionLayer {
+    GAME_COLLISION_LAYER_PLAYER = 0,
+    GAME_COLLISION_LAYER_ENEMY,
+    GAME_COLLISION_LAYER_PROJECTILE_PLAYER,
+    GAME_COLLISION_LAYER_PROJECTILE_ENEMY,
+} GameCollisionLayer;
+
+typedef enum GameCollisionEvent {
+    GAME_COLLISION_EVENT_NONE = COLLISION_EVENT_NONE,
+    GAME_COLLISION_EVENT_PROJECTILE_HITS_PLAYER,  // Enemy projectile against a player
+    GAME_COLLISION_EVENT_PROJECTILE_HITS_ENEMY,   // Player projectile against an enemy
+} GameCollisionEvent;
+
+typedef enum GameStage {
+    GAME_STAGE_PLAYERS = 0,
+    GAME_STAGE_MOVEMENT,
+    GAME_STAGE_LIFETIMES,
+    GAME_STAGE_COLLISION_CIRCLES,
+    GAME_STAGE_COLLISIONS,
+    GAME_STAGE_COUNT,
+} GameStage;
+
+#define GAME_STATE_MAX_PLAYERS GAME_REPLAY_MAX_PLAYERS  // Players of a session, each with its own input device
+
 typedef struct GameState {
     /* Time */
-    f64 time_elapsed;
-    f32 time_delta_real;
-    f32 time_delta_simulation;
+    f64 time_elapsed;           // Simulated seconds
+    f32 time_delta_real;        // Real seconds of the last frame
+    f32 time_delta_simulation;  // Simulated seconds of a tick
     i16 time_speed_magnitude;
     bool time_running;
+    f64 time_accumulator;  // Simulated seconds waiting for a tick
+    f32 time_alpha;        // Fraction of a tick waiting on the accumulator, to interpolate the drawing between the last two ticks
+    u64 time_ticks;        // Ticks simulated since the start
+    u32 time_frame_ticks;  // Ticks simulated on the last frame
+
+    /* Determinism */
+    Random random;      // Only source of randomness of the simulation, seeded by the replay
+    GameReplay replay;  // Seed and input log of the session
+
+    /* Players */
+    Player players[GAME_STATE_MAX_PLAYERS];
+    u8 player_count;
+    bool game_over[GAME_STATE_MAX_PLAYERS];  // Players without health left
+    bool gamepad_locked[MAX_GAMEPADS];       // Gamepads already used by a player
+
+    /* Entities */
+    EcsWorld world;  // Enemies and projectiles, as mixes of components
+
+    /* Collisions */
+    // World-space bounding circles computed once per tick after movement, reserved on the frame arena
+    CollisionWorld collision_world;
 
-    /* Player */
-    Player player;
-    bool game_over;
+    /* Jobs */
+    JobSystem jobs;  // Workers shared by the stages of the tick. Each stage waits on its jobs, so the next one sees their results
 
-    /* Inputs */
-    GreedyInputHandler input_handler;
+    /* Timings */
+    f64 stage_times[GAME_STAGE_COUNT];  // Seconds spent on every stage of the last tick
 
-    /* Entity pools */
-    ObjectPool enemies;
-    ObjectPool projectiles_players;
-    ObjectPool projectiles_enemies;
+    /* Frame memory */
+    Arena frame_arenas[2];  // Scratch memory of the current and the previous frames
+    u8 frame_arena_current;
 
     /* Textures */
     Texture2D spritesheet;
@@ -44,10 +105,24 @@ typedef struct GameState {
     /* Testing */
     bool testing_draw_bounding_circles;
     bool testing_draw_player_rotation;
+    TestingStressLayout testing_stress_layout;
+    u8 testing_commands;  // `TestingCommand` flags for the next tick
 } GameState;
 
 #define GAME_STATE_TIME_SPEED_MAGNITUDE_ABSOLUTE_MAX 5
 
+#define GAME_STATE_TICK_RATE           60                             // Simulation ticks per second, independent of the frame rate
+#define GAME_STATE_TICK_DELTA          (1.0f / GAME_STATE_TICK_RATE)  // Simulated seconds of every tick
+#define GAME_STATE_MAX_TICKS_PER_FRAME 5                              // Catch-up cap. The time beyond it is dropped, so slow frames slow the game down
+
+// Layers each kind of entity collides with
+#define GAME_COLLISION_MASK_PLAYER            CollisionLayerBit(GAME_COLLISION_LAYER_PROJECTILE_ENEMY)
+#define GAME_COLLISION_MASK_ENEMY             CollisionLayerBit(GAME_COLLISION_LAYER_PROJECTILE_PLAYER)
+#define GAME_COLLISION_MASK_PROJECTILE_PLAYER CollisionLayerBit(GAME_COLLISION_LAYER_ENEMY)
+#define GAME_COLLISION_MASK_PROJECTILE_ENEMY  CollisionLayerBit(GAME_COLLISION_LAYER_PLAYER)
+
+#define GAME_STATE_FRAME_ARENA_SIZE (64 * 1024)  // Initial bytes of each frame arena
+
 #define TEXTURE_POS_SPACESHIP_FRIENDLY_BASE     ((Rectangle){320, 0, 96, 96})
 #define TEXTURE_POS_SPACESHIP_FRIENDLY_UPGRADED ((Rectangle){304, 384, 96, 96})
 #define TEXTURE_POS_SPACESHIP_ENEMY_BASE        ((Rectangle){400, 256, 96, 96})
@@ -58,27 +133,56 @@ typedef struct GameState {
 
 #define TESTING_PLAYER_ROTATION_DIAGRAM_DISTANCE 300
 
-void GameStateInitialize(void);
-void GameStateUpdate(void);  // Call only if the state is initialized
+void GameStateInitialize(GameReplay replay);  // The replay seeds the simulation and is owned by the state
+u32 GameStateAdvanceTime(void);  // Call once per frame. Accumulates the time of the frame and returns the ticks to simulate
+void GameStateUpdate(void);      // Call at the start of every tick
 void GameStateCleanup(void);
+u64 GameStateHash(void);  // Hash of the simulated state, the same on every run with the same seed and input
 
 bool GameStatePlayerAdd(void);
 bool GameStatePlayerRemove(void);
-bool GameStateIsGameOver();
+bool GameStateIsGameOver();  // True once every player is game over
 void GameStateSetGameOver();
+bool GameStateIsPlayerGameOver(Player player);
+void GameStateSetPlayerGameOver(Player* player);
 
 Player GameStateGetClosestPlayer(Vector2 position);
 
-void GameStateSetDefaultMappings();
+void GameStateFrameArenaSwap(void);  // Call at the start of every frame
+Arena* GameStateFrameArena(void);          // Scratch memory freed at the start of the next frame
+Arena* GameStatePreviousFrameArena(void);  // Scratch memory of the previous frame, read only
 
 Rectangle SpaceshipTextureLocation(SpaceshipType type);    // Spaceship texture location
 Rectangle ProjectileTextureLocation(ProjectileType type);  // Proyectile texture location
 
+const char* GameStageName(GameStage stage);
+
 f32 ScaleToDelta(f32 value);
 Vector2 Vector2ScaleToDelta(Vector2 v);
+Vector2 Vector2InterpolateTicks(Vector2 position, Vector2 step);  // Position to draw between the last two ticks, from the movement of the last tick
 
 extern GameState* state;  // Game state global variable
 
+#define _FOR_EACH_PLAYER_REFERENCE_FROM(iteration_var, offset)                                                            \
+    for (                                                                                                                 \
+        struct {                                                                                                          \
+            u8 index;                                                                                                     \
+            Player* player;                                                                                               \
+        } iteration_var = {.index = (offset)};                                                                            \
+        iteration_var.index < state->player_count && (iteration_var.player = &state->players[iteration_var.index], true); \
+        ++iteration_var.index)
+#define _FOR_EACH_PLAYER_REFERENCE(iteration_var) _FOR_EACH_PLAYER_REFERENCE_FROM(iteration_var, 0)
+
+#define _FOR_EACH_PLAYER_VALUE_FROM(iteration_var, offset)                                                               \
+    for (                                                                                                                \
+        struct {                                                                                                         \
+            u8 index;                                                                                                    \
+            Player player;                                                                                               \
+        } iteration_var = {.index = (offset)};                                                                           \
+        iteration_var.index < state->player_count && (iteration_var.player = state->players[iteration_var.index], true); \
+        ++iteration_var.index)
+#define _FOR_EACH_PLAYER_VALUE(iteration_var) _FOR_EACH_PLAYER_VALUE_FROM(iteration_var, 0)
+
 /**
  * Custom for-each-loop to iterate over all the active players.
  *
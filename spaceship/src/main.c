@@ -1,12 +1,34 @@
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
 #include "lifecycles/game_lifecycle.h"
+#include "lifecycles/game_state.h"
 #include "types/types.h"
 
-i32 main(void) {
-    GameInitialize();  // Game initialization
-    GameLoop();        // Game loop
-    GameClear();       // Game cleaning
+// Usage: navecitas [--record <replay>] [--play <replay>]
+i32 main(i32 argc, char** argv) {
+    const char* record_path = NULL;  // Where to save the input of the session
+    const char* play_path = NULL;    // Session whose input is played instead of the devices
+    for (i32 i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--record") == 0) { record_path = argv[i + 1]; }
+        if (strcmp(argv[i], "--play") == 0) { play_path = argv[i + 1]; }
+    }
+
+    GameReplay replay = GameReplayCreate(record_path != NULL ? GAME_REPLAY_MODE_RECORD : GAME_REPLAY_MODE_LIVE, (u64)time(NULL));
+    if (play_path != NULL && !GameReplayLoad(&replay, play_path)) {
+        fprintf(stderr, "Invalid replay: %s\n", play_path);
+        return EXIT_FAILURE;
+    }
+
+    GameInitializeReplay(replay);  // Game initialization
+    GameLoop();                    // Game loop
+
+    if (record_path != NULL && play_path == NULL && !GameReplaySave(&state->replay, record_path)) { fprintf(stderr, "Could not save the replay: %s\n", record_path); }
+    if (state->replay.diverged) { fprintf(stderr, "Replay diverged on tick %llu\n", (unsigned long long)state->replay.diverged_tick); }
+
+    GameClear();  // Game cleaning
 
     return EXIT_SUCCESS;
 }
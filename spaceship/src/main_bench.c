@@ -0,0 +1,442 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "entities/collisions.h"
+#include "entities/entities.h"
+#include "lifecycles/game_lifecycle.h"
+#include "lifecycles/game_state.h"
+#include "platform/headless.h"
+#include "raylib/raymath.h"
+#include "types/arena.h"
+#include "types/ecs.h"
+#include "types/object_pool.h"
+#include "utils/extra_math.h"
+#include "utils/memory_utils.h"
+#include "utils/random.h"
+#include "types/types.h"
+
+#define BENCH_SEED 1  // Seed of every benchmark, so their runs can be compared
+
+volatile u64 bench_sink = 0;  // Results of the measured loops, so they are not optimized away
+
+f64 _BenchSeconds(void) {
+    struct timespec time;
+    timespec_get(&time, TIME_UTC);
+    return (f64)time.tv_sec + (f64)time.tv_nsec * 1e-9;
+}
+
+// ----------------------------------------------------------------------------
+// ---- Object pools ----------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+#define BENCH_POOL_CHURN_OPERATIONS 10000000  // Removes and adds of every churn run
+#define BENCH_POOL_GROWTH_FRAMES    2000
+#define BENCH_POOL_GROWTH_ADDS      500       // Adds of every frame of a growth run
+#define BENCH_POOL_TYPED_OBJECTS    100000
+#define BENCH_POOL_TYPED_PASSES     100       // Iterations over the whole typed pool
+
+typedef struct BenchObject {
+    byte data[100];
+} BenchObject;
+
+DEFINE_OBJECT_POOL(BenchObject)
+
+// Removes and adds back random objects of a full pool. The free list gives back the removed chunk, so every index stays valid
+void BenchPoolChurn(void) {
+    printf("%10s %18s\n", "live", "remove+add Mops/s");
+
+    const u32 lives[] = {1000, 100000, 1000000};
+    for (u32 l = 0; l < sizeof(lives) / sizeof(u32); ++l) {
+        ObjectPool pool = ObjectPoolCreate(sizeof(u64) * 4);
+        u64 object[4] = {0};
+        for (u32 i = 0; i < lives[l]; ++i) { ObjectPoolObjectAdd(&pool, object); }
+
+        Random random = RandomCreate(BENCH_SEED);
+        f64 start = _BenchSeconds();
+        for (u32 i = 0; i < BENCH_POOL_CHURN_OPERATIONS; ++i) {
+            ObjectPoolObjectRemove(&pool, RandomNext(&random) % lives[l]);
+            ObjectPoolObjectAdd(&pool, object);
+        }
+        f64 elapsed = _BenchSeconds() - start;
+
+        printf("%10u %18.1f\n", lives[l], BENCH_POOL_CHURN_OPERATIONS / elapsed / 1e6);
+        ObjectPoolDelete(&pool);
+    }
+}
+
+// Frames of 200 byte adds, so the pools keep growing. Contiguous pools move every object when they grow, paged ones add a page
+void BenchPoolGrowth(void) {
+    printf("%-10s %14s %14s %8s\n", "pool", "worst frame ms", "avg frame ms", "grows");
+
+    for (u32 paged = 0; paged < 2; ++paged) {
+        ObjectPool pool = paged ? ObjectPoolCreatePaged(200, DATA_OBJECT_POOL_DEFAULT_PAGE_CHUNKS) : ObjectPoolCreate(200);
+        byte object[200] = {0};
+
+        f64 worst = 0, total = 0;
+        for (u32 frame = 0; frame < BENCH_POOL_GROWTH_FRAMES; ++frame) {
+            f64 start = _BenchSeconds();
+            for (u32 i = 0; i < BENCH_POOL_GROWTH_ADDS; ++i) { ObjectPoolObjectAdd(&pool, object); }
+            f64 elapsed = _BenchSeconds() - start;
+
+            worst = max(worst, elapsed);
+            total += elapsed;
+        }
+
+        printf("%-10s %14.3f %14.4f %8u\n", paged ? "paged" : "contiguous", worst * 1000, total * 1000 / BENCH_POOL_GROWTH_FRAMES, pool.stats.grow_count);
+        ObjectPoolDelete(&pool);
+    }
+}
+
+// Removes and adds of 100 byte objects through the generic and the typed pools, then iterations over every object
+void BenchPoolTyped(void) {
+    printf("%-10s %16s %16s\n", "pool", "remove+add ns", "iterate ns/obj");
+
+    BenchObject object = {0};
+    Random random = RandomCreate(BENCH_SEED);
+
+    ObjectPool generic = ObjectPoolCreatePagedType(BenchObject, DATA_OBJECT_POOL_DEFAULT_PAGE_CHUNKS);
+    for (u32 i = 0; i < BENCH_POOL_TYPED_OBJECTS; ++i) { ObjectPoolObjectAdd(&generic, &object); }
+
+    f64 start = _BenchSeconds();
+    for (u32 i = 0; i < BENCH_POOL_CHURN_OPERATIONS; ++i) {
+        ObjectPoolObjectRemove(&generic, RandomNext(&random) % BENCH_POOL_TYPED_OBJECTS);
+        ObjectPoolObjectAdd(&generic, &object);
+    }
+    f64 churn = _BenchSeconds() - start;
+
+    start = _BenchSeconds();
+    for (u32 pass = 0; pass < BENCH_POOL_TYPED_PASSES; ++pass) {
+        ForEachObjectPoolObject(&generic, BenchObject, iter) { bench_sink += iter.object->data[0]; }
+    }
+    f64 iterate = _BenchSeconds() - start;
+
+    printf("%-10s %16.1f %16.2f\n", "generic", churn * 1e9 / BENCH_POOL_CHURN_OPERATIONS, iterate * 1e9 / (BENCH_POOL_TYPED_PASSES * BENCH_POOL_TYPED_OBJECTS));
+    ObjectPoolDelete(&generic);
+
+    BenchObjectPool typed = BenchObjectPoolCreate(DATA_OBJECT_POOL_DEFAULT_PAGE_CHUNKS);
+    for (u32 i = 0; i < BENCH_POOL_TYPED_OBJECTS; ++i) { BenchObjectPoolAdd(&typed, &object); }
+
+    start = _BenchSeconds();
+    for (u32 i = 0; i < BENCH_POOL_CHURN_OPERATIONS; ++i) {
+        BenchObjectPoolRemove(&typed, RandomNext(&random) % BENCH_POOL_TYPED_OBJECTS);
+        BenchObjectPoolAdd(&typed, &object);
+    }
+    churn = _BenchSeconds() - start;
+
+    start = _BenchSeconds();
+    for (u32 pass = 0; pass < BENCH_POOL_TYPED_PASSES; ++pass) {
+        ForEachTypedPoolObject(&typed, BenchObject, iter) { bench_sink += iter.object->data[0]; }
+    }
+    iterate = _BenchSeconds() - start;
+
+    printf("%-10s %16.1f %16.2f\n", "typed", churn * 1e9 / BENCH_POOL_CHURN_OPERATIONS, iterate * 1e9 / (BENCH_POOL_TYPED_PASSES * BENCH_POOL_TYPED_OBJECTS));
+    BenchObjectPoolDelete(&typed);
+}
+
+// ----------------------------------------------------------------------------
+// ---- Memory ----------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+#define BENCH_MEMORY_BYTES (1ull << 30)  // Bytes moved by every measurement
+
+typedef enum BenchMemoryRoutine {
+    BENCH_MEMORY_COPY = 0,
+    BENCH_MEMORY_LIBC_COPY,
+    BENCH_MEMORY_ZERO,
+    BENCH_MEMORY_LIBC_ZERO,
+} BenchMemoryRoutine;
+
+// Called through pointers, so the compiler can not turn the loops into a single call nor drop them
+void* (*volatile bench_memory_copy)(void*, const void*, size_t) = memory_copy;
+void* (*volatile bench_memcpy)(void*, const void*, size_t) = memcpy;
+void* (*volatile bench_memory_zero)(void*, size_t) = memory_zero;
+void* (*volatile bench_memset)(void*, int, size_t) = memset;
+
+// GB/s of a routine moving a buffer over and over
+f64 _BenchMemoryRate(BenchMemoryRoutine routine, byte* destination, const byte* source, usize size) {
+    u64 rounds = BENCH_MEMORY_BYTES / size;
+    f64 start = _BenchSeconds();
+    for (u64 round = 0; round < rounds; ++round) {
+        switch (routine) {
+            case BENCH_MEMORY_COPY: bench_memory_copy(destination, source, size); break;
+            case BENCH_MEMORY_LIBC_COPY: bench_memcpy(destination, source, size); break;
+            case BENCH_MEMORY_ZERO: bench_memory_zero(destination, size); break;
+            case BENCH_MEMORY_LIBC_ZERO: bench_memset(destination, 0, size); break;
+        }
+    }
+    return (f64)(rounds * size) / (_BenchSeconds() - start) / 1e9;
+}
+
+// Copies and zeroes of buffers of growing sizes, against the ones of libc
+void BenchMemory(void) {
+    printf("%10s %12s %12s %12s %12s  (GB/s)\n", "size", "memory_copy", "memcpy", "memory_zero", "memset");
+
+    const usize sizes[] = {16, 256, 4 * 1024, 1024 * 1024};
+    for (u32 s = 0; s < sizeof(sizes) / sizeof(usize); ++s) {
+        usize size = sizes[s];
+        byte* source = (byte*)malloc(size);
+        byte* destination = (byte*)malloc(size);
+        memset(source, 1, size);
+
+        f64 copy = _BenchMemoryRate(BENCH_MEMORY_COPY, destination, source, size);
+        f64 libc_copy = _BenchMemoryRate(BENCH_MEMORY_LIBC_COPY, destination, source, size);
+        f64 zero = _BenchMemoryRate(BENCH_MEMORY_ZERO, destination, source, size);
+        f64 libc_zero = _BenchMemoryRate(BENCH_MEMORY_LIBC_ZERO, destination, source, size);
+        bench_sink += destination[0];
+
+        printf("%10zu %12.1f %12.1f %12.1f %12.1f\n", size, copy, libc_copy, zero, libc_zero);
+        free(source);
+        free(destination);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// ---- Collisions ------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+#define BENCH_COLLISIONS_CIRCLES          10000  // Circles of every group
+#define BENCH_COLLISIONS_FRAMES           28     // Frames of small movement measured for the grid and sweep and prune
+#define BENCH_COLLISIONS_BRUTE_FRAMES     2      // Frames measured for brute force
+#define BENCH_COLLISIONS_AREA_SIZE        6000
+#define BENCH_COLLISIONS_CLUSTERS_SIDE    4      // Clusters per side of the area
+#define BENCH_COLLISIONS_CLUSTER_RADIUS   250
+#define BENCH_COLLISIONS_LINE_LENGTH      24000
+#define BENCH_COLLISIONS_LINE_WIDTH       150
+#define BENCH_COLLISIONS_MOTION           30     // Largest movement of a circle on every frame
+#define BENCH_COLLISIONS_RADIUS_TARGET    20.5f  // Radius of the enemies
+#define BENCH_COLLISIONS_RADIUS_PROJECTILE 5     // Radius of the projectiles
+#define BENCH_KERNEL_CIRCLES              10000
+#define BENCH_KERNEL_QUERIES              2000   // Circles tested against every batch
+#define BENCH_KERNEL_AREA_SIZE            300
+#define BENCH_KERNEL_RADIUS_MAX           20
+
+// Position of a circle on a layout of the collisions stress test
+Vector2 _BenchCollisionsPosition(Random* random, TestingStressLayout layout, u32 index) {
+    switch (layout) {
+        case TESTING_STRESS_LAYOUT_CLUSTERED: {
+            u32 cluster = index % (BENCH_COLLISIONS_CLUSTERS_SIDE * BENCH_COLLISIONS_CLUSTERS_SIDE);
+            f32 spacing = BENCH_COLLISIONS_AREA_SIZE / (f32)BENCH_COLLISIONS_CLUSTERS_SIDE;
+            f32 rotation = RandomValue(random, 0, 6283) / 1000.f;
+            f32 distance = RandomValue(random, 0, 1000) / 1000.f;
+            distance *= BENCH_COLLISIONS_CLUSTER_RADIUS * RandomValue(random, 0, 1000) / 1000.f;  // Denser at the center
+            return (Vector2){(cluster % BENCH_COLLISIONS_CLUSTERS_SIDE + 0.5f) * spacing + cosf(rotation) * distance,
+                             (cluster / BENCH_COLLISIONS_CLUSTERS_SIDE + 0.5f) * spacing + sinf(rotation) * distance};
+        }
+        case TESTING_STRESS_LAYOUT_LINE: {
+            f32 x = (f32)RandomValue(random, 0, BENCH_COLLISIONS_LINE_LENGTH);
+            f32 y = (f32)RandomValue(random, 0, BENCH_COLLISIONS_LINE_WIDTH);
+            return (Vector2){x, y};
+        }
+        case TESTING_STRESS_LAYOUT_UNIFORM:
+        default: {
+            f32 x = (f32)RandomValue(random, 0, BENCH_COLLISIONS_AREA_SIZE);
+            f32 y = (f32)RandomValue(random, 0, BENCH_COLLISIONS_AREA_SIZE);
+            return (Vector2){x, y};
+        }
+    }
+}
+
+// Movement of a circle on every frame. Projectiles of the line layout move along the line
+Vector2 _BenchCollisionsMotion(Random* random, TestingStressLayout layout, bool projectile) {
+    f32 x = (f32)RandomValue(random, -BENCH_COLLISIONS_MOTION, BENCH_COLLISIONS_MOTION);
+    f32 y = (f32)RandomValue(random, -BENCH_COLLISIONS_MOTION, BENCH_COLLISIONS_MOTION);
+    return layout == TESTING_STRESS_LAYOUT_LINE && projectile ? (Vector2){x, 0} : (Vector2){x, y};
+}
+
+// Overlap mask of a batch with the scalar test, circle by circle
+u64 _BenchKernelScalarMask(f32 x, f32 y, f32 radius, const f32* xs, const f32* ys, const f32* radiuses, u32 count) {
+    u64 mask = 0;
+    for (u32 k = 0; k < count; ++k) {
+        f32 dx = x - xs[k], dy = y - ys[k], radiuses_sum = radius + radiuses[k];
+        mask |= (u64)(dx * dx + dy * dy <= radiuses_sum * radiuses_sum) << k;
+    }
+    return mask;
+}
+
+// Circles against batches of every other circle with the batched overlap kernel, checked against the scalar test.
+// Centers and radiuses are integers on a small area, so many circles touch exactly
+void BenchKernel(void) {
+    printf("%10s %10s %16s %20s\n", "tests", "hits", "kernel Gtests/s", "mismatched batches");
+
+    Random random = RandomCreate(BENCH_SEED);
+    f32* xs = (f32*)malloc(sizeof(f32) * BENCH_KERNEL_CIRCLES);
+    f32* ys = (f32*)malloc(sizeof(f32) * BENCH_KERNEL_CIRCLES);
+    f32* radiuses = (f32*)malloc(sizeof(f32) * BENCH_KERNEL_CIRCLES);
+    for (u32 i = 0; i < BENCH_KERNEL_CIRCLES; ++i) {
+        xs[i] = (f32)RandomValue(&random, 0, BENCH_KERNEL_AREA_SIZE);
+        ys[i] = (f32)RandomValue(&random, 0, BENCH_KERNEL_AREA_SIZE);
+        radiuses[i] = (f32)RandomValue(&random, BENCH_COLLISIONS_RADIUS_PROJECTILE, BENCH_KERNEL_RADIUS_MAX);
+    }
+
+    u64 hits = 0;
+    f64 start = _BenchSeconds();
+    for (u32 i = 0; i < BENCH_KERNEL_QUERIES; ++i) {
+        for (u32 batch = 0; batch < BENCH_KERNEL_CIRCLES; batch += COLLISION_BATCH_SIZE) {
+            u32 count = min(BENCH_KERNEL_CIRCLES - batch, COLLISION_BATCH_SIZE);
+            hits += __builtin_popcountll(CollisionCircleOverlapMask(xs[i], ys[i], radiuses[i], xs + batch, ys + batch, radiuses + batch, count));
+        }
+    }
+    f64 elapsed = _BenchSeconds() - start;
+
+    u32 mismatches = 0;
+    for (u32 i = 0; i < BENCH_KERNEL_QUERIES; ++i) {
+        for (u32 batch = 0; batch < BENCH_KERNEL_CIRCLES; batch += COLLISION_BATCH_SIZE) {
+            u32 count = min(BENCH_KERNEL_CIRCLES - batch, COLLISION_BATCH_SIZE);
+            u64 kernel = CollisionCircleOverlapMask(xs[i], ys[i], radiuses[i], xs + batch, ys + batch, radiuses + batch, count);
+            mismatches += kernel != _BenchKernelScalarMask(xs[i], ys[i], radiuses[i], xs + batch, ys + batch, radiuses + batch, count);
+        }
+    }
+
+    f64 tests = (f64)BENCH_KERNEL_QUERIES * BENCH_KERNEL_CIRCLES;
+    printf("%10.0f %10llu %16.2f %20u\n", tests, (unsigned long long)hits, tests / elapsed / 1e9, mismatches);
+    free(xs);
+    free(ys);
+    free(radiuses);
+}
+
+// Player projectiles against enemies, as spawned by the collisions stress test, on every broadphase.
+// Brute force tests every pair, so its rate is the one of the batched overlap kernel
+void BenchBroadphases(void) {
+    printf("%-10s %8s %10s %16s %10s %10s  (ms per frame)\n", "layout", "pairs", "brute", "kernel Gtests/s", "grid", "sweep");
+
+    const CollisionBroadphase broadphases[] = {COLLISION_BROADPHASE_BRUTE_FORCE, COLLISION_BROADPHASE_GRID, COLLISION_BROADPHASE_SWEEP};
+
+    const char* layout_names[TESTING_STRESS_LAYOUT_COUNT] = {"uniform", "clustered", "line"};
+    for (TestingStressLayout layout = 0; layout < TESTING_STRESS_LAYOUT_COUNT; ++layout) {
+        Arena arena = ArenaCreate();
+        Random random = RandomCreate(BENCH_SEED);
+
+        CollisionCircles circles = CollisionCirclesCreate(&arena, 2 * BENCH_COLLISIONS_CIRCLES, BENCH_COLLISIONS_CIRCLES);
+        for (u32 i = 0; i < BENCH_COLLISIONS_CIRCLES; ++i) {
+            Vector2 enemy = _BenchCollisionsPosition(&random, layout, i);
+            Vector2 motion = _BenchCollisionsMotion(&random, layout, false);
+            CollisionCirclesAddSwept(&circles, enemy, (Vector2){enemy.x + motion.x, enemy.y + motion.y}, BENCH_COLLISIONS_RADIUS_TARGET, i,
+                                     GAME_COLLISION_LAYER_ENEMY, GAME_COLLISION_MASK_ENEMY);
+
+            Vector2 projectile = _BenchCollisionsPosition(&random, layout, i);
+            motion = _BenchCollisionsMotion(&random, layout, true);
+            CollisionCirclesAddSwept(&circles, projectile, (Vector2){projectile.x + motion.x, projectile.y + motion.y},
+                                     BENCH_COLLISIONS_RADIUS_PROJECTILE, i, GAME_COLLISION_LAYER_PROJECTILE_PLAYER, GAME_COLLISION_MASK_PROJECTILE_PLAYER);
+        }
+
+        CollisionPairs pairs[COLLISION_BROADPHASE_COUNT] = {0};  // One per broadphase, so sweep and prune keeps its order between frames
+        f64 totals[COLLISION_BROADPHASE_COUNT] = {0};
+        for (u32 frame = 0; frame < BENCH_COLLISIONS_FRAMES; ++frame) {
+            for (u32 b = 0; b < sizeof(broadphases) / sizeof(CollisionBroadphase); ++b) {
+                CollisionBroadphase broadphase = broadphases[b];
+                if (broadphase == COLLISION_BROADPHASE_BRUTE_FORCE && frame >= BENCH_COLLISIONS_BRUTE_FRAMES) { continue; }
+
+                f64 start = _BenchSeconds();
+                CollisionCirclesOverlaps(broadphase, circles, &pairs[broadphase], NULL, &arena);
+                totals[broadphase] += _BenchSeconds() - start;
+            }
+
+            for (u32 i = 0; i < circles.count; ++i) {
+                circles.x[i] += circles.motion_x[i];
+                circles.y[i] += circles.motion_y[i];
+            }
+        }
+
+        f64 brute = totals[COLLISION_BROADPHASE_BRUTE_FORCE] / BENCH_COLLISIONS_BRUTE_FRAMES;
+        f64 tests = (f64)circles.count * circles.count / 2;  // Every pair of circles, tested once
+        printf("%-10s %8u %10.2f %16.2f %10.3f %10.3f\n", layout_names[layout], pairs[COLLISION_BROADPHASE_GRID].count, brute * 1000, tests / brute / 1e9,
+               totals[COLLISION_BROADPHASE_GRID] * 1000 / BENCH_COLLISIONS_FRAMES, totals[COLLISION_BROADPHASE_SWEEP] * 1000 / BENCH_COLLISIONS_FRAMES);
+
+        for (CollisionBroadphase broadphase = 0; broadphase < COLLISION_BROADPHASE_COUNT; ++broadphase) { CollisionPairsDelete(&pairs[broadphase]); }
+        ArenaDelete(&arena);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// ---- Entities --------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+#define BENCH_MOVEMENT_PROJECTILES 1000000
+#define BENCH_MOVEMENT_TICKS       60
+#define BENCH_MOVEMENT_AREA_SIZE   100000  // Spread wide, so the projectiles barely collide
+#define BENCH_MOVEMENT_RANGE_MAX   200000  // Longest range of a projectile, so only a few expire on every tick
+
+// Ticks of a game with a million projectiles, measuring the ECS systems that run over all of them
+void BenchMovement(void) {
+    GameInitializeReplay(GameReplayCreate(GAME_REPLAY_MODE_LIVE, BENCH_SEED));
+    HeadlessFrameTimeSet(GAME_STATE_TICK_DELTA);
+
+    Random random = RandomCreate(BENCH_SEED);
+    for (u32 i = 0; i < BENCH_MOVEMENT_PROJECTILES; ++i) {
+        f32 x = (f32)RandomValue(&random, -BENCH_MOVEMENT_AREA_SIZE / 2, BENCH_MOVEMENT_AREA_SIZE / 2);
+        f32 y = (f32)RandomValue(&random, -BENCH_MOVEMENT_AREA_SIZE / 2, BENCH_MOVEMENT_AREA_SIZE / 2);
+        f32 rotation = Deg2Rad(RandomValue(&random, 0, MAX_DEGS));
+        u32 range = (u32)RandomValue(&random, PLAYER_ABILITY_SHOOT_RANGE, BENCH_MOVEMENT_RANGE_MAX);
+        ProjectileCreate(PROYECTILE_PLAYER, (Vector2){x, y}, PROJECTILE_BASIC_SIZE, PROJECTILE_BASIC_SPEED, rotation, PROJECTILE_BASIC_BOUNDING_CIRCLE(rotation),
+                         PLAYER_ABILITY_SHOOT_DAMAGE, range);
+    }
+
+    EcsArchetype* projectiles = EcsArchetypeFind(&state->world, ARCHETYPE_PROJECTILE);
+    u64 removes_start = projectiles->stats.total_removes;
+
+    f64 stage_totals[GAME_STAGE_COUNT] = {0};
+    while (state->time_ticks < BENCH_MOVEMENT_TICKS) {
+        GameStateFrameArenaSwap();
+        GameFrame();
+        HeadlessInputFrameEnd();
+
+        if (state->time_frame_ticks > 0) {
+            for (GameStage stage = 0; stage < GAME_STAGE_COUNT; ++stage) { stage_totals[stage] += state->stage_times[stage]; }
+        }
+    }
+
+    printf("%u projectiles, %.1f removed per tick\n", BENCH_MOVEMENT_PROJECTILES,
+           (f64)(projectiles->stats.total_removes - removes_start) / BENCH_MOVEMENT_TICKS);
+    for (GameStage stage = 0; stage < GAME_STAGE_COUNT; ++stage) {
+        printf("%-18s %10.3f ms per tick\n", GameStageName(stage), stage_totals[stage] * 1000 / BENCH_MOVEMENT_TICKS);
+    }
+
+    GameClear();
+}
+
+// ----------------------------------------------------------------------------
+// ---- Runner ----------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+typedef struct Benchmark {
+    const char* name;
+    void (*run)(void);
+} Benchmark;
+
+Benchmark benchmarks[] = {
+    {"pool_churn", BenchPoolChurn},
+    {"pool_growth", BenchPoolGrowth},
+    {"pool_typed", BenchPoolTyped},
+    {"memory", BenchMemory},
+    {"kernel", BenchKernel},
+    {"broadphases", BenchBroadphases},
+    {"movement", BenchMovement},
+};
+
+#define BENCHMARK_COUNT (sizeof(benchmarks) / sizeof(Benchmark))
+
+// Usage:
+//   navecitas_bench [benchmark]  Runs the benchmarks, or only the named one, and prints their results
+i32 main(i32 argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : NULL;
+    bool found = false;
+
+    for (u32 i = 0; i < BENCHMARK_COUNT; ++i) {
+        if (filter == NULL || strcmp(filter, benchmarks[i].name) == 0) {
+            printf("---- %s ----\n", benchmarks[i].name);
+            benchmarks[i].run();
+            printf("\n");
+            found = true;
+        }
+    }
+
+    if (!found) {
+        fprintf(stderr, "Unknown benchmark: %s\n", filter);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,252 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lifecycles/game_lifecycle.h"
+#include "lifecycles/game_state.h"
+#include "platform/headless.h"
+#include "types/ecs.h"
+#include "utils/memory_utils.h"
+#include "types/types.h"
+
+// ----------------------------------------------------------------------------
+// ---- Scenarios -------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+#define HEADLESS_SCENARIO_TICKS 1200  // Default length of a scenario, 20 simulated seconds
+#define HEADLESS_SEED           1     // Seed of every scenario, so their runs can be compared
+
+typedef struct HeadlessScenario {
+    const char* name;
+    void (*input)(u64 tick);  // Injects the input of a tick
+} HeadlessScenario;
+
+// Presses a key for a single tick
+void _HeadlessKeyTap(i32 key, u64 tick, u64 tap_tick) { HeadlessKeySet(key, tick == tap_tick); }
+
+// Moves the player around a square while shooting both weapons at a cursor circling the screen
+void _HeadlessFightInput(u64 tick) {
+    u32 side = (tick / 60) % 4;
+    HeadlessKeySet(KEY_W, side == 0);
+    HeadlessKeySet(KEY_D, side == 1);
+    HeadlessKeySet(KEY_S, side == 2);
+    HeadlessKeySet(KEY_A, side == 3);
+
+    f32 angle = tick * 0.05f;
+    HeadlessMousePositionSet((Vector2){GetScreenWidth() * (0.5f + 0.4f * cosf(angle)), GetScreenHeight() * (0.5f + 0.4f * sinf(angle))});
+    HeadlessMouseButtonSet(MOUSE_BUTTON_LEFT, true);
+    HeadlessMouseButtonSet(MOUSE_BUTTON_RIGHT, true);
+}
+
+void HeadlessScenarioIdle(u64 tick) { (void)tick; }
+
+void HeadlessScenarioFight(u64 tick) {
+    _HeadlessKeyTap(KEY_ONE, tick, 0);  // Enemies around the player
+    _HeadlessFightInput(tick);
+}
+
+// Collisions stress test spawned through the testing input, then fought through
+void _HeadlessScenarioStress(u64 tick, TestingStressLayout layout) {
+    if (tick == 0) { state->testing_stress_layout = layout; }
+    _HeadlessKeyTap(KEY_FIVE, tick, 0);
+    _HeadlessFightInput(tick);
+}
+
+void HeadlessScenarioStressUniform(u64 tick) { _HeadlessScenarioStress(tick, TESTING_STRESS_LAYOUT_UNIFORM); }
+
+void HeadlessScenarioStressClustered(u64 tick) { _HeadlessScenarioStress(tick, TESTING_STRESS_LAYOUT_CLUSTERED); }
+
+void HeadlessScenarioStressLine(u64 tick) { _HeadlessScenarioStress(tick, TESTING_STRESS_LAYOUT_LINE); }
+
+u32 headless_mismatches = 0;  // Ticks whose results did not match their check, on the scenarios that check the simulation
+
+int _HeadlessPairCompare(const void* a, const void* b) {
+    const CollisionPair *pair_a = (const CollisionPair*)a, *pair_b = (const CollisionPair*)b;
+    if (pair_a->a != pair_b->a) { return (pair_a->a > pair_b->a) - (pair_a->a < pair_b->a); }
+    return (pair_a->b > pair_b->b) - (pair_a->b < pair_b->b);
+}
+
+// Pairs of a list sorted by circle, so lists found by different broadphases can be compared
+CollisionPair* _HeadlessPairsSorted(CollisionPairs pairs, Arena* arena) {
+    CollisionPair* sorted = ArenaPushArray(arena, CollisionPair, max(pairs.count, 1));
+    if (pairs.count > 0) { memory_copy(sorted, pairs.pairs, sizeof(CollisionPair) * pairs.count); }
+    qsort(sorted, pairs.count, sizeof(CollisionPair), _HeadlessPairCompare);
+    return sorted;
+}
+
+// Collisions stress test fought with sweep and prune. Projectiles keep destroying and creating entities, so the records are reused
+// with newer generations. Before every tick, the pairs the sweep found on the last one are checked against the grid
+void HeadlessScenarioSweepRecycled(u64 tick) {
+    CollisionWorld* world = &state->collision_world;
+    if (tick == 0) { world->broadphase = COLLISION_BROADPHASE_SWEEP; }
+
+    if (tick > 0) {
+        Arena* arena = GameStateFrameArena();  // Still the arena of the last tick, where its circles are
+        ArenaScope(arena, check_marker) {
+            CollisionPairs grid = {0};
+            CollisionCirclesOverlaps(COLLISION_BROADPHASE_GRID, world->circles, &grid, NULL, arena);
+
+            bool matched = grid.count == world->pairs.count &&
+                           (grid.count == 0 || memcmp(_HeadlessPairsSorted(grid, arena), _HeadlessPairsSorted(world->pairs, arena), sizeof(CollisionPair) * grid.count) == 0);
+            if (!matched) {
+                fprintf(stderr, "Sweep pairs did not match the grid ones on tick %llu: %u against %u\n", (unsigned long long)(tick - 1), world->pairs.count, grid.count);
+                ++headless_mismatches;
+            }
+            CollisionPairsDelete(&grid);
+        }
+    }
+
+    _HeadlessScenarioStress(tick, TESTING_STRESS_LAYOUT_UNIFORM);
+}
+
+HeadlessScenario scenarios[] = {
+    {"idle", HeadlessScenarioIdle},
+    {"fight", HeadlessScenarioFight},
+    {"stress_uniform", HeadlessScenarioStressUniform},
+    {"stress_clustered", HeadlessScenarioStressClustered},
+    {"stress_line", HeadlessScenarioStressLine},
+    {"sweep_recycled", HeadlessScenarioSweepRecycled},
+};
+
+#define HEADLESS_SCENARIO_COUNT (sizeof(scenarios) / sizeof(HeadlessScenario))
+
+// ----------------------------------------------------------------------------
+// ---- Runner ----------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+f64 _HeadlessRunnerSeconds(void) {
+    struct timespec time;
+    timespec_get(&time, TIME_UTC);
+    return (f64)time.tv_sec + (f64)time.tv_nsec * 1e-9;
+}
+
+u32 _HeadlessEntityCount(void) {
+    u32 count = 0;
+    ForEachEcsArchetype(&state->world, 0, iter) { count += iter.archetype->count; }
+    return count;
+}
+
+// Runs a session from a new game as fast as possible, one tick per frame, and prints its timings
+void HeadlessRun(const char* name, void (*input)(u64 tick), GameReplay replay, u64 ticks) {
+    f64 stage_totals[GAME_STAGE_COUNT] = {0};
+    u32 peak_entities = 0;
+
+    GameInitializeReplay(replay);
+    HeadlessFrameTimeSet(GAME_STATE_TICK_DELTA);
+
+    f64 start = _HeadlessRunnerSeconds();
+    while (state->time_ticks < ticks) {
+        if (input != NULL) { input(state->time_ticks); }
+
+        GameStateFrameArenaSwap();
+        GameFrame();
+        HeadlessInputFrameEnd();
+
+        if (state->time_frame_ticks > 0) {
+            for (GameStage stage = 0; stage < GAME_STAGE_COUNT; ++stage) { stage_totals[stage] += state->stage_times[stage]; }
+        }
+        peak_entities = max(peak_entities, _HeadlessEntityCount());
+    }
+    f64 elapsed = _HeadlessRunnerSeconds() - start;
+
+    printf("%-18s %8llu %12.1f %10u", name, (unsigned long long)ticks, ticks / elapsed, peak_entities);
+    for (GameStage stage = 0; stage < GAME_STAGE_COUNT; ++stage) { printf(" %10.4f", stage_totals[stage] * 1000 / ticks); }
+    printf("\n");
+
+    // Usage counters of every archetype used by the session
+    for (u32 a = 0; a < state->world.archetype_count; ++a) {
+        const EcsArchetype* archetype = &state->world.archetypes[a];
+        EcsArchetypeStats stats = archetype->stats;
+        printf("  archetype 0x%02x: +%llu -%llu, peak %u, %.1f KiB reserved, %u grows (%.3f ms total, max %.3f ms)\n", archetype->mask,
+               (unsigned long long)stats.total_adds, (unsigned long long)stats.total_removes, stats.peak_count,
+               EcsArchetypeBytesReserved(&state->world, archetype) / 1024.0, stats.grow_count, stats.grow_time_total * 1000, stats.grow_time_max * 1000);
+    }
+}
+
+void _HeadlessPrintHeader(void) {
+    printf("%-18s %8s %12s %10s", "scenario", "ticks", "ticks/s", "entities");
+    for (GameStage stage = 0; stage < GAME_STAGE_COUNT; ++stage) { printf(" %10s", GameStageName(stage)); }
+    printf("  (ms per tick)\n");
+}
+
+HeadlessScenario* _HeadlessScenarioFind(const char* name) {
+    for (u32 i = 0; i < HEADLESS_SCENARIO_COUNT; ++i) {
+        if (strcmp(name, scenarios[i].name) == 0) { return &scenarios[i]; }
+    }
+    return NULL;
+}
+
+// Runs a scenario storing its input on a replay
+i32 HeadlessRecord(const char* name, u64 ticks, const char* path) {
+    HeadlessScenario* scenario = _HeadlessScenarioFind(name);
+    if (scenario == NULL) {
+        fprintf(stderr, "Unknown scenario: %s\n", name);
+        return EXIT_FAILURE;
+    }
+
+    _HeadlessPrintHeader();
+    HeadlessRun(scenario->name, scenario->input, GameReplayCreate(GAME_REPLAY_MODE_RECORD, HEADLESS_SEED), ticks);
+
+    bool saved = GameReplaySave(&state->replay, path);
+    if (saved) {
+        printf("Recorded %llu ticks on %s (%zu bytes of input and hashes)\n", (unsigned long long)state->replay.tick_count, path, state->replay.log_size);
+    } else {
+        fprintf(stderr, "Could not save the replay: %s\n", path);
+    }
+
+    GameClear();
+    return saved ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Replays a session, checking the state of every tick matches the recorded one
+i32 HeadlessPlay(const char* path) {
+    GameReplay replay;
+    if (!GameReplayLoad(&replay, path)) {
+        fprintf(stderr, "Invalid replay: %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    _HeadlessPrintHeader();
+    HeadlessRun("replay", NULL, replay, replay.tick_count);
+
+    bool diverged = state->replay.diverged;
+    if (diverged) {
+        fprintf(stderr, "Replay diverged on tick %llu\n", (unsigned long long)state->replay.diverged_tick);
+    } else {
+        printf("Replay matched on all its %llu ticks\n", (unsigned long long)state->time_ticks);
+    }
+
+    GameClear();
+    return diverged ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// Usage:
+//   navecitas_headless [scenario] [ticks]                Runs the scenarios and prints their timings
+//   navecitas_headless record <scenario> <ticks> <file>  Runs a scenario storing its input on a replay
+//   navecitas_headless play <file>                       Replays a session, checking every tick matches it
+i32 main(i32 argc, char** argv) {
+    if (argc > 4 && strcmp(argv[1], "record") == 0) { return HeadlessRecord(argv[2], strtoull(argv[3], NULL, 10), argv[4]); }
+    if (argc > 2 && strcmp(argv[1], "play") == 0) { return HeadlessPlay(argv[2]); }
+
+    const char* filter = argc > 1 ? argv[1] : NULL;
+    u64 ticks = argc > 2 ? strtoull(argv[2], NULL, 10) : HEADLESS_SCENARIO_TICKS;
+    bool found = false;
+
+    _HeadlessPrintHeader();
+    for (u32 i = 0; i < HEADLESS_SCENARIO_COUNT; ++i) {
+        if (filter == NULL || strcmp(filter, scenarios[i].name) == 0) {
+            HeadlessRun(scenarios[i].name, scenarios[i].input, GameReplayCreate(GAME_REPLAY_MODE_LIVE, HEADLESS_SEED), ticks);
+            GameClear();
+            found = true;
+        }
+    }
+
+    if (!found) {
+        fprintf(stderr, "Unknown scenario: %s\n", filter);
+        return EXIT_FAILURE;
+    }
+
+    return headless_mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,234 @@
+#include <time.h>
+
+#include "platform/headless.h"
+#include "utils/memory_utils.h"
+#include "raylib/config.h"
+#include "raylib/raylib.h"
+#include "types/types.h"
+
+#define HEADLESS_SCREEN_WIDTH  1920
+#define HEADLESS_SCREEN_HEIGHT 1080
+#define HEADLESS_REFRESH_RATE  60
+
+typedef struct {
+    bool current[MAX_KEYBOARD_KEYS];
+    bool previous[MAX_KEYBOARD_KEYS];
+} HeadlessKeys;
+
+typedef struct {
+    bool current[MAX_MOUSE_BUTTONS];
+    bool previous[MAX_MOUSE_BUTTONS];
+    Vector2 position;
+    Vector2 previous_position;
+} HeadlessMouse;
+
+typedef struct {
+    bool available;
+    bool current[MAX_GAMEPAD_BUTTONS];
+    bool previous[MAX_GAMEPAD_BUTTONS];
+    f32 axes[MAX_GAMEPAD_AXIS];
+} HeadlessGamepad;
+
+struct {
+    f32 frame_time;
+    f64 start_time;
+
+    HeadlessKeys keys;
+    HeadlessMouse mouse;
+    HeadlessGamepad gamepads[MAX_GAMEPADS];
+} headless = {.frame_time = 1.0f / HEADLESS_REFRESH_RATE};
+
+f64 _HeadlessSeconds(void) {
+    struct timespec time;
+    timespec_get(&time, TIME_UTC);
+    return (f64)time.tv_sec + (f64)time.tv_nsec * 1e-9;
+}
+
+bool _HeadlessKeyValid(i32 key) { return key >= 0 && key < MAX_KEYBOARD_KEYS; }
+
+bool _HeadlessMouseButtonValid(i32 button) { return button >= 0 && button < MAX_MOUSE_BUTTONS; }
+
+bool _HeadlessGamepadButtonValid(i32 gamepad, i32 button) {
+    return gamepad >= 0 && gamepad < MAX_GAMEPADS && headless.gamepads[gamepad].available && button >= 0 && button < MAX_GAMEPAD_BUTTONS;
+}
+
+// ----------------------------------------------------------------------------
+// ---- Injection -------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+void HeadlessFrameTimeSet(f32 seconds) { headless.frame_time = seconds; }
+
+void HeadlessInputFrameEnd(void) {
+    memory_copy(headless.keys.previous, headless.keys.current, sizeof(headless.keys.current));
+    memory_copy(headless.mouse.previous, headless.mouse.current, sizeof(headless.mouse.current));
+    headless.mouse.previous_position = headless.mouse.position;
+    for (i32 g = 0; g < MAX_GAMEPADS; ++g) {
+        memory_copy(headless.gamepads[g].previous, headless.gamepads[g].current, sizeof(headless.gamepads[g].current));
+    }
+}
+
+void HeadlessKeySet(i32 key, bool down) {
+    if (_HeadlessKeyValid(key)) { headless.keys.current[key] = down; }
+}
+
+void HeadlessMouseButtonSet(i32 button, bool down) {
+    if (_HeadlessMouseButtonValid(button)) { headless.mouse.current[button] = down; }
+}
+
+void HeadlessMousePositionSet(Vector2 position) { headless.mouse.position = position; }
+
+void HeadlessGamepadAvailableSet(i32 gamepad, bool available) {
+    if (gamepad >= 0 && gamepad < MAX_GAMEPADS) { headless.gamepads[gamepad] = (HeadlessGamepad){.available = available}; }
+}
+
+void HeadlessGamepadButtonSet(i32 gamepad, i32 button, bool down) {
+    if (_HeadlessGamepadButtonValid(gamepad, button)) { headless.gamepads[gamepad].current[button] = down; }
+}
+
+void HeadlessGamepadAxisSet(i32 gamepad, i32 axis, f32 value) {
+    if (gamepad >= 0 && gamepad < MAX_GAMEPADS && axis >= 0 && axis < MAX_GAMEPAD_AXIS) { headless.gamepads[gamepad].axes[axis] = value; }
+}
+
+// ----------------------------------------------------------------------------
+// ---- Window and timing -----------------------------------------------------
+// ----------------------------------------------------------------------------
+
+void InitWindow(int width, int height, const char* title) {
+    (void)width, (void)height, (void)title;
+    headless.start_time = _HeadlessSeconds();
+}
+
+void CloseWindow(void) {}
+
+bool WindowShouldClose(void) { return false; }
+
+void MaximizeWindow(void) {}
+
+void ToggleFullscreen(void) {}
+
+void ToggleBorderlessWindowed(void) {}
+
+void SetWindowState(unsigned int flags) { (void)flags; }
+
+void SetWindowIcon(Image image) { (void)image; }
+
+void SetExitKey(int key) { (void)key; }
+
+void SetTargetFPS(int fps) { (void)fps; }
+
+int GetCurrentMonitor(void) { return 0; }
+
+int GetMonitorWidth(int monitor) { return (void)monitor, HEADLESS_SCREEN_WIDTH; }
+
+int GetMonitorHeight(int monitor) { return (void)monitor, HEADLESS_SCREEN_HEIGHT; }
+
+int GetMonitorRefreshRate(int monitor) { return (void)monitor, HEADLESS_REFRESH_RATE; }
+
+int GetScreenWidth(void) { return HEADLESS_SCREEN_WIDTH; }
+
+int GetScreenHeight(void) { return HEADLESS_SCREEN_HEIGHT; }
+
+float GetFrameTime(void) { return headless.frame_time; }
+
+// Real time, only used to measure how long the game takes
+double GetTime(void) { return _HeadlessSeconds() - headless.start_time; }
+
+// ----------------------------------------------------------------------------
+// ---- Input -----------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+bool IsKeyDown(int key) { return _HeadlessKeyValid(key) && headless.keys.current[key]; }
+
+bool IsKeyUp(int key) { return !IsKeyDown(key); }
+
+bool IsKeyPressed(int key) { return _HeadlessKeyValid(key) && headless.keys.current[key] && !headless.keys.previous[key]; }
+
+bool IsKeyReleased(int key) { return _HeadlessKeyValid(key) && !headless.keys.current[key] && headless.keys.previous[key]; }
+
+bool IsMouseButtonDown(int button) { return _HeadlessMouseButtonValid(button) && headless.mouse.current[button]; }
+
+bool IsMouseButtonUp(int button) { return !IsMouseButtonDown(button); }
+
+bool IsMouseButtonPressed(int button) { return _HeadlessMouseButtonValid(button) && headless.mouse.current[button] && !headless.mouse.previous[button]; }
+
+bool IsMouseButtonReleased(int button) { return _HeadlessMouseButtonValid(button) && !headless.mouse.current[button] && headless.mouse.previous[button]; }
+
+Vector2 GetMousePosition(void) { return headless.mouse.position; }
+
+Vector2 GetMouseDelta(void) {
+    return (Vector2){headless.mouse.position.x - headless.mouse.previous_position.x, headless.mouse.position.y - headless.mouse.previous_position.y};
+}
+
+float GetMouseWheelMove(void) { return 0; }
+
+bool IsGamepadAvailable(int gamepad) { return gamepad >= 0 && gamepad < MAX_GAMEPADS && headless.gamepads[gamepad].available; }
+
+bool IsGamepadButtonDown(int gamepad, int button) { return _HeadlessGamepadButtonValid(gamepad, button) && headless.gamepads[gamepad].current[button]; }
+
+bool IsGamepadButtonUp(int gamepad, int button) { return !IsGamepadButtonDown(gamepad, button); }
+
+bool IsGamepadButtonPressed(int gamepad, int button) {
+    return _HeadlessGamepadButtonValid(gamepad, button) && headless.gamepads[gamepad].current[button] && !headless.gamepads[gamepad].previous[button];
+}
+
+bool IsGamepadButtonReleased(int gamepad, int button) {
+    return _HeadlessGamepadButtonValid(gamepad, button) && !headless.gamepads[gamepad].current[button] && headless.gamepads[gamepad].previous[button];
+}
+
+float GetGamepadAxisMovement(int gamepad, int axis) {
+    if (!IsGamepadAvailable(gamepad) || axis < 0 || axis >= MAX_GAMEPAD_AXIS) { return 0; }
+    return headless.gamepads[gamepad].axes[axis];
+}
+
+// ----------------------------------------------------------------------------
+// ---- Resources -------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+// Nothing is loaded, so the game never reads the assets folder
+
+Image LoadImage(const char* fileName) { return (void)fileName, (Image){0}; }
+
+void UnloadImage(Image image) { (void)image; }
+
+Texture2D LoadTextureFromImage(Image image) { return (void)image, (Texture2D){0}; }
+
+void UnloadTexture(Texture2D texture) { (void)texture; }
+
+Font LoadFont(const char* fileName) { return (void)fileName, (Font){0}; }
+
+void UnloadFont(Font font) { (void)font; }
+
+// ----------------------------------------------------------------------------
+// ---- Drawing ---------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+// Linked by the drawing code, never called by the headless runner
+
+void BeginDrawing(void) {}
+
+void EndDrawing(void) { HeadlessInputFrameEnd(); }
+
+void ClearBackground(Color color) { (void)color; }
+
+void DrawFPS(int posX, int posY) { (void)posX, (void)posY; }
+
+void DrawLineV(Vector2 startPos, Vector2 endPos, Color color) { (void)startPos, (void)endPos, (void)color; }
+
+void DrawCircleLinesV(Vector2 center, float radius, Color color) { (void)center, (void)radius, (void)color; }
+
+void DrawRectangleV(Vector2 position, Vector2 size, Color color) { (void)position, (void)size, (void)color; }
+
+void DrawTexturePro(Texture2D texture, Rectangle source, Rectangle dest, Vector2 origin, float rotation, Color tint) {
+    (void)texture, (void)source, (void)dest, (void)origin, (void)rotation, (void)tint;
+}
+
+void DrawTextEx(Font font, const char* text, Vector2 position, float fontSize, float spacing, Color tint) {
+    (void)font, (void)text, (void)position, (void)fontSize, (void)spacing, (void)tint;
+}
+
+Vector2 MeasureTextEx(Font font, const char* text, float fontSize, float spacing) { return (void)font, (void)text, (void)fontSize, (void)spacing, (Vector2){0}; }
+
+Color Fade(Color color, float alpha) {
+    color.a = (unsigned char)(minmax(alpha, 0.0f, 1.0f) * 255);
+    return color;
+}
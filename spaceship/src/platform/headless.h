@@ -0,0 +1,64 @@
+#pragma once
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include "raylib/raylib.h"
+#include "types/types.h"
+
+// ----------------------------------------------------------------------------
+// ---- Headless platform -----------------------------------------------------
+// ----------------------------------------------------------------------------
+
+// Stand-in for the raylib platform layer, linked instead of raylib by the headless build.
+// There is no window, textures nor fonts, the frame time is set by hand and the input is injected.
+
+/**
+ * Sets the time returned as the duration of every frame.
+ * @param seconds Seconds of a frame.
+ */
+void HeadlessFrameTimeSet(f32 seconds);
+/**
+ * Ends the input of a frame. The keys and buttons set after it are compared against the ones of the ended frame
+ * to detect presses and releases, as raylib does when polling its events.
+ */
+void HeadlessInputFrameEnd(void);
+
+/**
+ * Sets the state of a key.
+ * @param key Key to set. One of `KeyboardKey`.
+ * @param down True if the key is being pressed.
+ */
+void HeadlessKeySet(i32 key, bool down);
+/**
+ * Sets the state of a mouse button.
+ * @param button Button to set. One of `MouseButton`.
+ * @param down True if the button is being pressed.
+ */
+void HeadlessMouseButtonSet(i32 button, bool down);
+/**
+ * Sets the position of the mouse cursor. The mouse delta of the frame is computed from the last position.
+ * @param position New position of the cursor.
+ */
+void HeadlessMousePositionSet(Vector2 position);
+/**
+ * Connects or disconnects a gamepad.
+ * @param gamepad Gamepad to set.
+ * @param available True if the gamepad is connected.
+ */
+void HeadlessGamepadAvailableSet(i32 gamepad, bool available);
+/**
+ * Sets the state of a gamepad button.
+ * @param gamepad Gamepad of the button.
+ * @param button Button to set. One of `GamepadButton`.
+ * @param down True if the button is being pressed.
+ */
+void HeadlessGamepadButtonSet(i32 gamepad, i32 button, bool down);
+/**
+ * Sets the movement of a gamepad axis.
+ * @param gamepad Gamepad of the axis.
+ * @param axis Axis to set. One of `GamepadAxis`.
+ * @param value Movement of the axis, from -1 to 1.
+ */
+void HeadlessGamepadAxisSet(i32 gamepad, i32 axis, f32 value);
+
+#endif  // HEADLESS_H
@@ -1,38 +1,123 @@
+#include <stdint.h>
 #include <stdlib.h>
 
 #include "arena.h"
+#include "utils/memory_utils.h"
 
 #define DEFAULT_ARENA_PAGE_BYTE_SIZES 1024
 
-Arena ArenaCreateCustom(size_t size) { return (Arena){malloc(size), size, 0}; }
+// Block memory starts right after its header
+#define ArenaBlockMemory(block) ((char *)((block) + 1))
+
+ArenaBlock *_ArenaBlockCreate(size_t size)
+{
+    ArenaBlock *block = malloc(sizeof(ArenaBlock) + size);
+    *block = (ArenaBlock){.prev = NULL, .next = NULL, .size = size, .used = 0, .start = 0};
+    return block;
+}
+
+// Moves to the next block of the chain, reusing it if it is big enough
+void _ArenaBlockAdvance(Arena *arena, size_t size)
+{
+    ArenaBlock *current = arena->current;
+    ArenaBlock *next = current->next;
+
+    if (next != NULL && next->size < size)
+    {
+        current->next = next->next;
+        if (next->next != NULL) { next->next->prev = current; }
+        free(next);
+        next = current->next;
+    }
+
+    if (next == NULL || next->size < size)
+    {
+        size_t next_size = current->size * 2;
+        while (next_size < size) { next_size *= 2; }
+
+        ArenaBlock *block = _ArenaBlockCreate(next_size);
+        block->prev = current;
+        block->next = next;
+        if (next != NULL) { next->prev = block; }
+        current->next = block;
+        next = block;
+    }
+
+    next->used = 0;
+    next->start = current->start + current->used;
+    arena->current = next;
+}
+
+Arena ArenaCreateCustom(size_t size)
+{
+    ArenaBlock *block = _ArenaBlockCreate(size > 0 ? size : DEFAULT_ARENA_PAGE_BYTE_SIZES);
+    return (Arena){block, block};
+}
 
 Arena ArenaCreate(void) { return ArenaCreateCustom(DEFAULT_ARENA_PAGE_BYTE_SIZES); }
 
-void ArenaDelete(Arena *arena) { free(arena->memory); };
+void ArenaDelete(Arena *arena)
+{
+    for (ArenaBlock *block = arena->first, *next; block != NULL; block = next)
+    {
+        next = block->next;
+        free(block);
+    }
+    arena->first = arena->current = NULL;
+};
+
+// Bytes to skip on the current block to reach the alignment
+size_t _ArenaPadding(ArenaBlock *block, size_t align) { return (size_t)(-(uintptr_t)(ArenaBlockMemory(block) + block->used) & (align - 1)); }
 
-void *ArenaPush(Arena *arena, size_t size)
+void *ArenaPushAligned(Arena *arena, size_t size, size_t align)
 {
-    if (arena->memory_size - arena->memory_pos < size)
+    size_t padding = _ArenaPadding(arena->current, align);
+    if (arena->current->size - arena->current->used < size + padding)
     {
-        do {
-            arena->memory_size *= 2;
-        } while (arena->memory_size - arena->memory_pos < size);
-        arena->memory = realloc(arena->memory, arena->memory_size);
+        _ArenaBlockAdvance(arena, size + align - 1);
+        padding = _ArenaPadding(arena->current, align);
     }
-    void *reserved_memory = (void *)((uintptr_t)arena->memory + arena->memory_pos);
-    arena->memory_pos += size;
+
+    ArenaBlock *block = arena->current;
+    void *reserved_memory = ArenaBlockMemory(block) + block->used + padding;
+    block->used += padding + size;
     return reserved_memory;
 }
 
-void *ArenaPushZero(Arena *arena, size_t size)
+void *ArenaPush(Arena *arena, size_t size) { return ArenaPushAligned(arena, size, 1); }
+
+void *ArenaPushZeroAligned(Arena *arena, size_t size, size_t align)
 {
-    void *reserved_memory = ArenaPush(arena, size);
-    for (char *m = reserved_memory; size; --size) { *(m++) = 0; }
-    return reserved_memory;
+    return memory_zero(ArenaPushAligned(arena, size, align), size);
 }
 
-void ArenaPop(Arena *arena, size_t size) { arena->memory_pos = arena->memory_pos < size ? 0 : arena->memory_pos - size; }
+void *ArenaPushZero(Arena *arena, size_t size) { return ArenaPushZeroAligned(arena, size, 1); }
 
-void ArenaClear(Arena *arena) { arena->memory_pos = 0; }
+void ArenaPop(Arena *arena, size_t size)
+{
+    ArenaBlock *block = arena->current;
+    while (size > block->used && block->prev != NULL)
+    {
+        size -= block->used;
+        block->used = 0;
+        block = block->prev;
+    }
+    block->used = block->used < size ? 0 : block->used - size;
+    arena->current = block;
+}
+
+void ArenaClear(Arena *arena)
+{
+    arena->current = arena->first;
+    arena->first->used = 0;
+}
+
+ArenaMarker ArenaMark(Arena *arena) { return (ArenaMarker){arena->current, arena->current->used}; }
+
+void ArenaRestore(Arena *arena, ArenaMarker marker)
+{
+    arena->current = marker.block;
+    marker.block->used = marker.used;
+}
 
-size_t ArenaSize(Arena arena) { return arena.memory_pos; }
+size_t ArenaSize(Arena arena) { return arena.current->start + arena.current->used; }
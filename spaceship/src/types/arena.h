@@ -4,13 +4,39 @@
 
 #include <stddef.h>
 
+#define ARENA_CACHE_LINE_SIZE 64 // Alignment for hot buffers, so they do not share cache lines with other data
+
+/**
+ * Memory block of an arena. The reserved bytes follow the block header.
+ */
+typedef struct ArenaBlock
+{
+    struct ArenaBlock *prev;
+    struct ArenaBlock *next;
+    size_t size;  // Size in bytes of the block
+    size_t used;  // Bytes in use of the block
+    size_t start; // Bytes in use on the previous blocks when this block was entered
+} ArenaBlock;
+
+/**
+ * Memory arena made of a chain of blocks. Growing appends a new block instead of moving the old ones,
+ * so the reserved pointers stay valid until they are popped or the arena is cleared.
+ */
 typedef struct Arena
 {
-    void *memory;
-    size_t memory_size;
-    size_t memory_pos;
+    ArenaBlock *first;
+    ArenaBlock *current;
 } Arena;
 
+/**
+ * Position of an arena, to free everything reserved after it at once.
+ */
+typedef struct ArenaMarker
+{
+    ArenaBlock *block;
+    size_t used;
+} ArenaMarker;
+
 /**
  * Creates an arena with the default size.
  * @returns New arena.
@@ -35,13 +61,28 @@ void ArenaDelete(Arena *arena);
  * @returns Pointer to the reserved memory.
  */
 void *ArenaPush(Arena *arena, size_t size);
+/**
+ * Reserves some bytes on an arena at an aligned address.
+ * @param arena Arena to use.
+ * @param size Number of bytes to reserve.
+ * @param align Alignment in bytes of the reserved memory. Must be a power of two.
+ * @returns Pointer to the reserved memory.
+ */
+void *ArenaPushAligned(Arena *arena, size_t size, size_t align);
+/**
+ * Reserves some bytes on an arena aligned to a cache line.
+ * @param arena Arena to use.
+ * @param size Number of bytes to reserve.
+ * @returns Pointer to the reserved memory.
+ */
+#define ArenaPushCacheLine(arena, size) ArenaPushAligned((arena), (size), ARENA_CACHE_LINE_SIZE)
 /**
  * Reserves some bytes for a type on an arena.
  * @param arena Arena to use.
  * @param type Type of the data.
  * @returns Pointer to the reserved memory.
  */
-#define ArenaPushType(arena, type) (type *)ArenaPush((arena), sizeof(type))
+#define ArenaPushType(arena, type) (type *)ArenaPushAligned((arena), sizeof(type), _Alignof(type))
 /**
  * Reserves some bytes on an arena and set them to 0.
  * @param arena Arena to use.
@@ -49,13 +90,21 @@ void *ArenaPush(Arena *arena, size_t size);
  * @returns Pointer to the reserved memory.
  */
 void *ArenaPushZero(Arena *arena, size_t size);
+/**
+ * Reserves some bytes on an arena at an aligned address and set them to 0.
+ * @param arena Arena to use.
+ * @param size Number of bytes to reserve.
+ * @param align Alignment in bytes of the reserved memory. Must be a power of two.
+ * @returns Pointer to the reserved memory.
+ */
+void *ArenaPushZeroAligned(Arena *arena, size_t size, size_t align);
 /**
  * Reserves some bytes for a type on an arena and set them to 0.
  * @param arena Arena to use.
  * @param type Type of the data.
  * @returns Pointer to the reserved memory.
  */
-#define ArenaPushTypeZero(arena, type) (type *)ArenaPushZero((arena), sizeof(type))
+#define ArenaPushTypeZero(arena, type) (type *)ArenaPushZeroAligned((arena), sizeof(type), _Alignof(type))
 /**
  * Reserves some bytes for a type array on an arena.
  * @param arena Arena to use.
@@ -63,7 +112,15 @@ void *ArenaPushZero(Arena *arena, size_t size);
  * @param count Size of the array.
  * @returns Pointer to the reserved memory.
  */
-#define ArenaPushArray(arena, type, count) (type *)ArenaPush((arena), sizeof(type) * (count))
+#define ArenaPushArray(arena, type, count) (type *)ArenaPushAligned((arena), sizeof(type) * (count), _Alignof(type))
+/**
+ * Reserves some bytes for a type array on an arena aligned to a cache line.
+ * @param arena Arena to use.
+ * @param type Type of the array's data.
+ * @param count Size of the array.
+ * @returns Pointer to the reserved memory.
+ */
+#define ArenaPushArrayCacheLine(arena, type, count) (type *)ArenaPushCacheLine((arena), sizeof(type) * (count))
 /**
  * Reserves some bytes for a type array on an arena and set them to 0.
  * @param arena Arena to use.
@@ -71,10 +128,10 @@ void *ArenaPushZero(Arena *arena, size_t size);
  * @param count Size of the array.
  * @returns Pointer to the reserved memory.
  */
-#define ArenaPushArrayZero(arena, type, count) (type *)ArenaPushZero((arena), sizeof(type) * (count))
+#define ArenaPushArrayZero(arena, type, count) (type *)ArenaPushZeroAligned((arena), sizeof(type) * (count), _Alignof(type))
 
 /**
- * Frees some bytes from an arena.
+ * Frees some bytes from an arena. Padding added by aligned pushes is only freed on clear.
  * @param arena Arena to use.
  * @param size Number of bytes to free.
  */
@@ -98,6 +155,28 @@ void ArenaPop(Arena *arena, size_t size);
  */
 void ArenaClear(Arena *arena);
 
+/**
+ * Saves the current position of an arena.
+ * @param arena Arena to use.
+ * @returns Marker of the current position.
+ */
+ArenaMarker ArenaMark(Arena *arena);
+/**
+ * Frees all bytes reserved on an arena after a marker was saved. Blocks are kept for reuse.
+ * @param arena Arena to use.
+ * @param marker Marker saved from the same arena. Markers saved after it become invalid.
+ */
+void ArenaRestore(Arena *arena, ArenaMarker marker);
+/**
+ * Custom scope for temporary reservations on an arena. Everything reserved inside is freed when the scope ends.
+ * Leaving the scope with break, goto or return skips the restore.
+ *
+ * @param arena Arena to use.
+ * @param marker_var Name of the variable where the marker of the scope will be stored.
+ */
+#define ArenaScope(arena, marker_var) \
+    for (ArenaMarker marker_var = ArenaMark(arena); marker_var.block != NULL; ArenaRestore((arena), marker_var), marker_var.block = NULL)
+
 /**
  * Gets the used space of an arena.
  * @param arena Arena to use.
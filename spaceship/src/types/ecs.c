@@ -0,0 +1,194 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "types/ecs.h"
+#include "utils/memory_utils.h"
+#include "types/types.h"
+
+f64 _EcsSeconds(void) {
+    struct timespec time;
+    timespec_get(&time, TIME_UTC);
+    return (f64)time.tv_sec + (f64)time.tv_nsec * 1e-9;
+}
+
+EcsEntity _EcsEntityAt(const EcsWorld* world, u32 record) { return (EcsEntity){((u32)world->generations[record] << ECS_ENTITY_INDEX_BITS) | record}; }
+
+u32 _EcsEntityRecord(EcsEntity entity) { return entity.handle & ECS_ENTITY_INDEX_MASK; }
+
+// Invalidates every handle to the record. Generation 0 is skipped on wrap around
+void _EcsGenerationAdvance(EcsWorld* world, u32 record) {
+    world->generations[record] = (world->generations[record] + 1) & ECS_ENTITY_GENERATION_MASK;
+    if (world->generations[record] == 0) { world->generations[record] = ECS_ENTITY_FIRST_GENERATION; }
+}
+
+EcsWorld EcsWorldCreate(const usize* component_sizes, u32 component_count) {
+    EcsWorld world = {.component_count = component_count, .free_record = ECS_NO_FREE_RECORD, .free_record_last = ECS_NO_FREE_RECORD};
+    memory_copy(world.component_sizes, component_sizes, sizeof(usize) * component_count);
+    return world;
+}
+
+void EcsWorldDelete(EcsWorld* world) {
+    for (u32 a = 0; a < world->archetype_count; ++a) {
+        EcsArchetype* archetype = &world->archetypes[a];
+        free(archetype->entities);
+        for (u32 c = 0; c < world->component_count; ++c) { free(archetype->columns[c]); }
+    }
+    free(world->record_archetypes);
+    free(world->record_rows);
+    free(world->generations);
+    *world = (EcsWorld){0};
+}
+
+EcsArchetype* EcsArchetypeFind(EcsWorld* world, EcsComponentMask mask) {
+    for (u32 a = 0; a < world->archetype_count; ++a) {
+        if (world->archetypes[a].mask == mask) { return &world->archetypes[a]; }
+    }
+    return NULL;
+}
+
+// Finds the archetype of a mix of components, adding it if it is the first entity with that mix
+EcsArchetype* _EcsArchetypeFindOrAdd(EcsWorld* world, EcsComponentMask mask) {
+    EcsArchetype* archetype = EcsArchetypeFind(world, mask);
+    if (archetype == NULL && world->archetype_count < ECS_MAX_ARCHETYPES) {
+        archetype = &world->archetypes[world->archetype_count++];
+        *archetype = (EcsArchetype){.mask = mask};
+    }
+    return archetype;
+}
+
+// Doubles every column of an archetype. Only the columns of its components are reserved
+void _EcsArchetypeGrow(const EcsWorld* world, EcsArchetype* archetype) {
+    f64 grow_start = _EcsSeconds();
+    u32 capacity = max(archetype->capacity * 2, ECS_ARCHETYPE_MIN_ROWS);
+
+    archetype->entities = (EcsEntity*)realloc(archetype->entities, sizeof(EcsEntity) * capacity);
+    for (u32 c = 0; c < world->component_count; ++c) {
+        if (archetype->mask & EcsComponentBit(c)) { archetype->columns[c] = (byte*)realloc(archetype->columns[c], world->component_sizes[c] * capacity); }
+    }
+    archetype->capacity = capacity;
+
+    EcsArchetypeStats* stats = &archetype->stats;
+    stats->grow_time_last = _EcsSeconds() - grow_start;
+    stats->grow_time_max = max(stats->grow_time_max, stats->grow_time_last);
+    stats->grow_time_total += stats->grow_time_last;
+    ++stats->grow_count;
+}
+
+// Takes the dead record that died first from the free list, or a new one from the end of the records
+u32 _EcsRecordAcquire(EcsWorld* world) {
+    if (world->free_record != ECS_NO_FREE_RECORD) {
+        u32 record = world->free_record;
+        world->free_record = world->record_rows[record];
+        if (world->free_record == ECS_NO_FREE_RECORD) { world->free_record_last = ECS_NO_FREE_RECORD; }
+        return record;
+    }
+
+    assert(world->record_count <= ECS_ENTITY_INDEX_MASK && "Entity records do not fit on the index of the handles");
+
+    if (world->record_count == world->record_capacity) {
+        u32 capacity = max(world->record_capacity * 2, ECS_ARCHETYPE_MIN_ROWS);
+        world->record_archetypes = (u8*)realloc(world->record_archetypes, sizeof(u8) * capacity);
+        world->record_rows = (u32*)realloc(world->record_rows, sizeof(u32) * capacity);
+        world->generations = (u16*)realloc(world->generations, sizeof(u16) * capacity);
+        world->record_capacity = capacity;
+    }
+
+    u32 record = world->record_count++;
+    world->generations[record] = ECS_ENTITY_FIRST_GENERATION;
+    return record;
+}
+
+EcsEntity EcsEntityCreate(EcsWorld* world, EcsComponentMask mask) {
+    EcsArchetype* archetype = _EcsArchetypeFindOrAdd(world, mask);
+    if (archetype == NULL) { return ECS_ENTITY_NULL; }
+    if (archetype->count == archetype->capacity) { _EcsArchetypeGrow(world, archetype); }
+
+    u32 record = _EcsRecordAcquire(world);
+    u32 row = archetype->count++;
+
+    EcsEntity entity = _EcsEntityAt(world, record);
+    archetype->entities[row] = entity;
+    world->record_archetypes[record] = (u8)(archetype - world->archetypes);
+    world->record_rows[record] = row;
+
+    ++archetype->stats.frame_adds;
+    ++archetype->stats.total_adds;
+    archetype->stats.peak_count = max(archetype->stats.peak_count, archetype->count);
+    return entity;
+}
+
+bool EcsEntityIsAlive(const EcsWorld* world, EcsEntity entity) {
+    u32 record = _EcsEntityRecord(entity);
+    return entity.handle != ECS_ENTITY_NULL.handle && record < world->record_count && _EcsEntityAt(world, record).handle == entity.handle;
+}
+
+void* EcsEntityComponent(const EcsWorld* world, EcsEntity entity, u32 component) {
+    if (!EcsEntityIsAlive(world, entity)) { return NULL; }
+
+    u32 record = _EcsEntityRecord(entity);
+    const EcsArchetype* archetype = &world->archetypes[world->record_archetypes[record]];
+    if (!(archetype->mask & EcsComponentBit(component))) { return NULL; }
+
+    return archetype->columns[component] + world->component_sizes[component] * world->record_rows[record];
+}
+
+void EcsEntityDestroy(EcsWorld* world, EcsEntity entity) {
+    if (!EcsEntityIsAlive(world, entity)) { return; }
+
+    u32 record = _EcsEntityRecord(entity);
+    EcsArchetypeRemove(world, &world->archetypes[world->record_archetypes[record]], world->record_rows[record]);
+}
+
+void EcsArchetypeRemove(EcsWorld* world, EcsArchetype* archetype, u32 row) {
+    u32 record = _EcsEntityRecord(archetype->entities[row]);
+    u32 last = --archetype->count;
+    ++archetype->stats.frame_removes;
+    ++archetype->stats.total_removes;
+
+    // Keep the rows packed
+    if (row != last) {
+        for (u32 c = 0; c < world->component_count; ++c) {
+            if (archetype->mask & EcsComponentBit(c)) {
+                usize component_size = world->component_sizes[c];
+                memory_copy(archetype->columns[c] + component_size * row, archetype->columns[c] + component_size * last, component_size);
+            }
+        }
+        archetype->entities[row] = archetype->entities[last];
+        world->record_rows[_EcsEntityRecord(archetype->entities[row])] = row;
+    }
+
+    // Queue the record, so it is reused after the ones that died before
+    _EcsGenerationAdvance(world, record);
+    world->record_rows[record] = ECS_NO_FREE_RECORD;
+    if (world->free_record_last == ECS_NO_FREE_RECORD) {
+        world->free_record = record;
+    } else {
+        world->record_rows[world->free_record_last] = record;
+    }
+    world->free_record_last = record;
+}
+
+void EcsArchetypeClear(EcsWorld* world, EcsArchetype* archetype) {
+    while (archetype->count > 0) { EcsArchetypeRemove(world, archetype, archetype->count - 1); }
+}
+
+void EcsWorldStatsFrameReset(EcsWorld* world) {
+    for (u32 a = 0; a < world->archetype_count; ++a) {
+        world->archetypes[a].stats.frame_adds = 0;
+        world->archetypes[a].stats.frame_removes = 0;
+    }
+}
+
+// Bytes of a row of an archetype: its entity and every component of its mask
+usize _EcsArchetypeRowSize(const EcsWorld* world, const EcsArchetype* archetype) {
+    usize size = sizeof(EcsEntity);
+    for (u32 c = 0; c < world->component_count; ++c) {
+        if (archetype->mask & EcsComponentBit(c)) { size += world->component_sizes[c]; }
+    }
+    return size;
+}
+
+usize EcsArchetypeBytesReserved(const EcsWorld* world, const EcsArchetype* archetype) { return _EcsArchetypeRowSize(world, archetype) * archetype->capacity; }
+
+usize EcsArchetypeBytesUsed(const EcsWorld* world, const EcsArchetype* archetype) { return _EcsArchetypeRowSize(world, archetype) * archetype->count; }
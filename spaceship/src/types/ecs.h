@@ -0,0 +1,223 @@
+#pragma once
+#ifndef ECS_H
+#define ECS_H
+
+#include "types/types.h"
+
+#define ECS_MAX_COMPONENTS       32          // Components a world can register, one bit each on a component mask
+#define ECS_MAX_ARCHETYPES       64          // Distinct component mixes a world can hold
+#define ECS_ARCHETYPE_MIN_ROWS   64          // Rows reserved by every column when an archetype is first used
+#define ECS_NO_FREE_RECORD       UINT32_MAX  // Free list terminator
+#define ECS_ENTITY_INDEX_BITS       20                                          // Bits of an entity handle used by the record index
+#define ECS_ENTITY_INDEX_MASK       ((1u << ECS_ENTITY_INDEX_BITS) - 1)         // Mask of the record index of an entity handle
+#define ECS_ENTITY_GENERATION_MASK  ((1u << (32 - ECS_ENTITY_INDEX_BITS)) - 1)  // Mask of the generation of a record, wrapped around past it
+#define ECS_ENTITY_FIRST_GENERATION 1                                           // Generation 0 is reserved for the null entity
+
+typedef u32 EcsComponentMask;  // Bit set of the components of an entity
+
+#define EcsComponentBit(component) ((EcsComponentMask)1 << (component))
+
+/**
+ * Generational handle of an entity of an ECS world.
+ * Packs the record index in the lower bits and the record generation in the upper ones,
+ * so handles of destroyed entities are detected even after their record is reused.
+ * Dead records are reused oldest first, so a stale handle only resolves again after every free record wrapped its generation.
+ */
+typedef struct {
+    u32 handle;
+} EcsEntity;
+
+#define ECS_ENTITY_NULL ((EcsEntity){0})  // Handle that never resolves to an entity
+
+/**
+ * Usage counters of an archetype. Only increments and comparisons on the hot paths, so they are always enabled.
+ */
+typedef struct {
+    u32 frame_adds;       // Entities added since the last frame reset
+    u32 frame_removes;    // Entities removed since the last frame reset
+    u64 total_adds;       // Entities added since the creation of the archetype
+    u64 total_removes;    // Entities removed since the creation of the archetype
+    u32 peak_count;       // Highest number of entities
+    u32 grow_count;       // Times the columns reserved more memory
+    f64 grow_time_last;   // Seconds spent on the last memory reservation
+    f64 grow_time_max;    // Seconds spent on the slowest memory reservation
+    f64 grow_time_total;  // Seconds spent on all the memory reservations
+} EcsArchetypeStats;
+
+/**
+ * Entities sharing the same mix of components. Every component of the mix is stored in its own dense column,
+ * so systems only stream through the columns they use. Rows are kept packed by moving the last row over the removed ones.
+ */
+typedef struct {
+    EcsComponentMask mask;
+    u32 count;
+    u32 capacity;
+    EcsEntity* entities;                // Entity of every row
+    byte* columns[ECS_MAX_COMPONENTS];  // Column of every component of the mask, NULL for the rest
+    EcsArchetypeStats stats;
+} EcsArchetype;
+
+typedef struct {
+    usize component_sizes[ECS_MAX_COMPONENTS];
+    u32 component_count;
+
+    EcsArchetype archetypes[ECS_MAX_ARCHETYPES];
+    u32 archetype_count;
+
+    // Entity records, indexed by the handles
+    u8* record_archetypes;  // Archetype of every entity
+    u32* record_rows;       // Row of every entity inside its archetype. Links the free list on dead records
+    u16* generations;       // Generation of every record, increased every time its entity is destroyed
+    u32 record_count;
+    u32 record_capacity;
+    u32 free_record;       // Head of the free list threaded through the dead records, the one that died first
+    u32 free_record_last;  // Tail of the free list, where dead records are queued
+} EcsWorld;
+
+/**
+ * Creates an ECS world.
+ * @param component_sizes Size of every component, indexed by component.
+ * @param component_count Number of components. At most `ECS_MAX_COMPONENTS`.
+ * @return New ECS world.
+ */
+EcsWorld EcsWorldCreate(const usize* component_sizes, u32 component_count);
+/**
+ * Deletes an ECS world and all of its entities.
+ * @param world World to delete.
+ */
+void EcsWorldDelete(EcsWorld* world);
+
+/**
+ * Creates an entity with a mix of components. The components are left uninitialized.
+ * @param world World to use.
+ * @param mask Components of the entity.
+ * @return Handle of the new entity, or `ECS_ENTITY_NULL` if the archetype could not be added because `ECS_MAX_ARCHETYPES` were in use.
+ */
+EcsEntity EcsEntityCreate(EcsWorld* world, EcsComponentMask mask);
+/**
+ * Destroys an entity, moving the last entity of its archetype to its row. Does nothing if the entity was already destroyed.
+ * @param world World to use.
+ * @param entity Entity to destroy.
+ */
+void EcsEntityDestroy(EcsWorld* world, EcsEntity entity);
+/**
+ * Checks if an entity has not been destroyed.
+ * @param world World to use.
+ * @param entity Entity to check.
+ * @return True if the entity is alive.
+ */
+bool EcsEntityIsAlive(const EcsWorld* world, EcsEntity entity);
+/**
+ * Gets a component of an entity.
+ * The pointer is invalidated by any creation or destruction of entities of the same archetype.
+ * @param world World to use.
+ * @param entity Entity to use.
+ * @param component Component to get.
+ * @return Pointer to the component, or NULL if the entity was destroyed or does not have the component.
+ */
+void* EcsEntityComponent(const EcsWorld* world, EcsEntity entity, u32 component);
+/**
+ * Gets a component of an entity as a type.
+ * @param world World to use.
+ * @param entity Entity to use.
+ * @param component Component to get.
+ * @param type Type of the component.
+ * @return Pointer to the component, or NULL if the entity was destroyed or does not have the component.
+ */
+#define EcsEntityComponentType(world, entity, component, type) ((type*)EcsEntityComponent((world), (entity), (component)))
+
+/**
+ * Finds the archetype of a mix of components.
+ * @param world World to use.
+ * @param mask Exact components of the archetype.
+ * @return Archetype of the mix, or NULL if no entity with that mix was ever created.
+ */
+EcsArchetype* EcsArchetypeFind(EcsWorld* world, EcsComponentMask mask);
+/**
+ * Destroys the entity of a row of an archetype, moving the last row of the archetype to it.
+ * Iterate backwards when removing rows inside a loop over the archetype.
+ * @param world World to use.
+ * @param archetype Archetype of the row.
+ * @param row Row to remove.
+ */
+void EcsArchetypeRemove(EcsWorld* world, EcsArchetype* archetype, u32 row);
+/**
+ * Destroys every entity of an archetype.
+ * @param world World to use.
+ * @param archetype Archetype to clear.
+ */
+void EcsArchetypeClear(EcsWorld* world, EcsArchetype* archetype);
+
+/**
+ * Resets the per-frame usage counters of every archetype of a world. Call once at the start of every frame.
+ * @param world World to use.
+ */
+void EcsWorldStatsFrameReset(EcsWorld* world);
+/**
+ * Retrieves the bytes reserved by the columns of an archetype.
+ * @param world World of the archetype.
+ * @param archetype Archetype to check.
+ * @return Reserved bytes.
+ */
+usize EcsArchetypeBytesReserved(const EcsWorld* world, const EcsArchetype* archetype);
+/**
+ * Retrieves the bytes used by the entities of an archetype.
+ * @param world World of the archetype.
+ * @param archetype Archetype to check.
+ * @return Used bytes.
+ */
+usize EcsArchetypeBytesUsed(const EcsWorld* world, const EcsArchetype* archetype);
+
+/**
+ * Gets the column of a component of an archetype as an array of a type.
+ * @param archetype Archetype to use.
+ * @param component Component of the column. Must be part of the archetype.
+ * @param type Type of the component.
+ * @return Array with the component of every row.
+ */
+#define EcsColumn(archetype, component, type) ((type*)(archetype)->columns[component])
+
+/**
+ * Finds the next non-empty archetype with, at least, some components. Used by `ForEachEcsArchetype`.
+ * @param world World to use.
+ * @param required_mask Components the archetype must have.
+ * @param index Index of the first archetype to check.
+ * @return Index of the archetype found, or the archetype count if there are no more.
+ */
+static inline u32 EcsArchetypeNextMatch(const EcsWorld* world, EcsComponentMask required_mask, u32 index) {
+    while (index < world->archetype_count) {
+        const EcsArchetype* archetype = &world->archetypes[index];
+        if ((archetype->mask & required_mask) == required_mask && archetype->count > 0) { return index; }
+        ++index;
+    }
+    return world->archetype_count;
+}
+
+/**
+ * Custom for-each-loop to iterate over the archetypes with, at least, some components. Systems run an inner loop over the rows of every archetype.
+ *
+ * @param world World to use.
+ * @param required_mask Components every iterated archetype must have.
+ * @param iteration_var Name of the variable where all the iteration information will be stored.
+ * @param iteration_var.index `u32` Index of the current archetype.
+ * @param iteration_var.archetype `EcsArchetype *` Pointer to the archetype.
+ *
+ * Usage:
+ * ```
+ * ForEachEcsArchetype(&world, EcsComponentBit(COMPONENT_HEALTH), itr) {
+ *     Health* health = EcsColumn(itr.archetype, COMPONENT_HEALTH, Health);
+ *     for (u32 row = 0; row < itr.archetype->count; ++row) { printf("Health: %u\n", health[row].current); }
+ * }
+ * ```
+ */
+#define ForEachEcsArchetype(world, required_mask, iteration_var)                                        \
+    for (                                                                                               \
+        struct {                                                                                        \
+            u32 index;                                                                                  \
+            EcsArchetype* archetype;                                                                    \
+        } iteration_var = {EcsArchetypeNextMatch((world), (required_mask), 0), NULL};                   \
+        iteration_var.index < (world)->archetype_count &&                                               \
+        (iteration_var.archetype = &(world)->archetypes[iteration_var.index]);                          \
+        iteration_var.index = EcsArchetypeNextMatch((world), (required_mask), iteration_var.index + 1))
+
+#endif  // ECS_H
@@ -0,0 +1,243 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+#include "types/jobs.h"
+#include "types/types.h"
+
+#define JOB_QUEUE_MASK (JOB_QUEUE_CAPACITY - 1)
+
+_Static_assert((JOB_QUEUE_CAPACITY & JOB_QUEUE_MASK) == 0, "The capacity of the job queues must be a power of two");
+
+// Job stored on a queue. A thief may read a slot while the owner fills it again, then fails to take it and drops what it read,
+// so the fields are atomic. Relaxed, as the order is given by the indices of the queue
+typedef struct JobSlot {
+    _Atomic(JobFunction) function;
+    _Atomic(void*) data;
+    atomic_uint first;
+    atomic_uint last;
+    _Atomic(JobCounter*) counter;
+} JobSlot;
+
+_Thread_local u32 _job_worker_index = 0;  // Queue of the calling thread. The thread that started the system owns the first one
+
+u32 _JobProcessorCount(void) {
+#if defined(_WIN32)
+    return (u32)pthread_num_processors_np();  // winpthreads
+#else
+    return (u32)max(sysconf(_SC_NPROCESSORS_ONLN), 1);
+#endif
+}
+
+void _JobExecute(Job job) {
+    job.function(job.data, job.first, job.last);
+    atomic_fetch_sub_explicit(&job.counter->pending, 1, memory_order_release);
+}
+
+// ----------------------------------------------------------------------------
+// ---- Job queues ------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+void _JobSlotStore(JobSlot* slot, Job job) {
+    atomic_store_explicit(&slot->function, job.function, memory_order_relaxed);
+    atomic_store_explicit(&slot->data, job.data, memory_order_relaxed);
+    atomic_store_explicit(&slot->first, job.first, memory_order_relaxed);
+    atomic_store_explicit(&slot->last, job.last, memory_order_relaxed);
+    atomic_store_explicit(&slot->counter, job.counter, memory_order_relaxed);
+}
+
+Job _JobSlotLoad(JobSlot* slot) {
+    return (Job){.function = atomic_load_explicit(&slot->function, memory_order_relaxed),
+                 .data = atomic_load_explicit(&slot->data, memory_order_relaxed),
+                 .first = atomic_load_explicit(&slot->first, memory_order_relaxed),
+                 .last = atomic_load_explicit(&slot->last, memory_order_relaxed),
+                 .counter = atomic_load_explicit(&slot->counter, memory_order_relaxed)};
+}
+
+// Only called by the owner. Fails if the queue is full
+bool _JobQueuePush(JobQueue* queue, Job job) {
+    i64 bottom = atomic_load_explicit(&queue->bottom, memory_order_relaxed);
+    i64 top = atomic_load_explicit(&queue->top, memory_order_acquire);
+    if (bottom - top >= JOB_QUEUE_CAPACITY) { return false; }
+
+    _JobSlotStore(&queue->slots[bottom & JOB_QUEUE_MASK], job);
+    atomic_store_explicit(&queue->bottom, bottom + 1, memory_order_release);
+    return true;
+}
+
+// Only called by the owner. Takes the latest job
+bool _JobQueuePop(JobQueue* queue, Job* job) {
+    i64 bottom = atomic_load_explicit(&queue->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&queue->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    i64 top = atomic_load_explicit(&queue->top, memory_order_relaxed);
+
+    if (top > bottom) {  // Empty
+        atomic_store_explicit(&queue->bottom, bottom + 1, memory_order_relaxed);
+        return false;
+    }
+
+    *job = _JobSlotLoad(&queue->slots[bottom & JOB_QUEUE_MASK]);
+    if (top < bottom) { return true; }
+
+    // Last job, also reachable by the thieves
+    bool taken = atomic_compare_exchange_strong_explicit(&queue->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed);
+    atomic_store_explicit(&queue->bottom, bottom + 1, memory_order_relaxed);
+    return taken;
+}
+
+// Called by any other worker. Takes the oldest job
+bool _JobQueueSteal(JobQueue* queue, Job* job) {
+    i64 top = atomic_load_explicit(&queue->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    i64 bottom = atomic_load_explicit(&queue->bottom, memory_order_acquire);
+    if (top >= bottom) { return false; }
+
+    *job = _JobSlotLoad(&queue->slots[top & JOB_QUEUE_MASK]);
+    return atomic_compare_exchange_strong_explicit(&queue->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed);
+}
+
+// ----------------------------------------------------------------------------
+// ---- Workers ---------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+// Takes a job from the queue of a worker, or steals one from the rest, starting with the next worker
+bool _JobTake(JobSystem* jobs, u32 worker, Job* job) {
+    bool taken = _JobQueuePop(&jobs->queues[worker], job);
+    for (u32 k = 1; !taken && k < jobs->worker_count; ++k) { taken = _JobQueueSteal(&jobs->queues[(worker + k) % jobs->worker_count], job); }
+
+    if (taken) { atomic_fetch_sub(&jobs->queued, 1); }
+    return taken;
+}
+
+// Wakes the sleeping workers after some jobs were pushed. Sleepers check the queued jobs under the mutex, so none misses the jobs
+void _JobWake(JobSystem* jobs, bool all) {
+    if (atomic_load(&jobs->sleeping) == 0) { return; }
+
+    pthread_mutex_lock(&jobs->mutex);
+    if (all) {
+        pthread_cond_broadcast(&jobs->wake);
+    } else {
+        pthread_cond_signal(&jobs->wake);
+    }
+    pthread_mutex_unlock(&jobs->mutex);
+}
+
+void _JobSleep(JobSystem* jobs) {
+    pthread_mutex_lock(&jobs->mutex);
+    atomic_fetch_add(&jobs->sleeping, 1);
+    while (atomic_load(&jobs->running) && atomic_load(&jobs->queued) == 0) { pthread_cond_wait(&jobs->wake, &jobs->mutex); }
+    atomic_fetch_sub(&jobs->sleeping, 1);
+    pthread_mutex_unlock(&jobs->mutex);
+}
+
+void* _JobWorkerMain(void* argument) {
+    JobWorker* worker = (JobWorker*)argument;
+    JobSystem* jobs = worker->system;
+    _job_worker_index = worker->index;
+
+    u32 idle_rounds = 0;
+    while (atomic_load(&jobs->running)) {
+        Job job;
+        if (_JobTake(jobs, worker->index, &job)) {
+            _JobExecute(job);
+            idle_rounds = 0;
+        } else if (++idle_rounds < JOB_SPIN_ROUNDS) {
+            sched_yield();
+        } else {
+            _JobSleep(jobs);
+            idle_rounds = 0;
+        }
+    }
+    return NULL;
+}
+
+// ----------------------------------------------------------------------------
+// ---- Job system ------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+void JobSystemStart(JobSystem* jobs, u32 worker_count) {
+    if (worker_count == 0) { worker_count = _JobProcessorCount(); }
+    *jobs = (JobSystem){.worker_count = minmax(worker_count, 1, JOB_MAX_WORKERS)};
+    atomic_init(&jobs->running, true);
+    atomic_init(&jobs->queued, 0);
+    atomic_init(&jobs->sleeping, 0);
+    pthread_mutex_init(&jobs->mutex, NULL);
+    pthread_cond_init(&jobs->wake, NULL);
+    _job_worker_index = 0;
+
+    for (u32 w = 0; w < jobs->worker_count; ++w) {
+        jobs->queues[w].slots = reserve_a(JobSlot, JOB_QUEUE_CAPACITY);
+        atomic_init(&jobs->queues[w].top, 0);
+        atomic_init(&jobs->queues[w].bottom, 0);
+        jobs->workers[w] = (JobWorker){.system = jobs, .index = w};
+    }
+
+    // Only the owner pushes to a queue, so the queues of the threads that could not be started just stay empty
+    for (u32 w = 1; w < jobs->worker_count; ++w) {
+        jobs->workers[w].started = pthread_create(&jobs->workers[w].thread, NULL, _JobWorkerMain, &jobs->workers[w]) == 0;
+    }
+}
+
+void JobSystemStop(JobSystem* jobs) {
+    pthread_mutex_lock(&jobs->mutex);
+    atomic_store(&jobs->running, false);
+    pthread_cond_broadcast(&jobs->wake);
+    pthread_mutex_unlock(&jobs->mutex);
+
+    for (u32 w = 1; w < jobs->worker_count; ++w) {
+        if (jobs->workers[w].started) { pthread_join(jobs->workers[w].thread, NULL); }
+    }
+    for (u32 w = 0; w < JOB_MAX_WORKERS; ++w) { free(jobs->queues[w].slots); }
+
+    pthread_cond_destroy(&jobs->wake);
+    pthread_mutex_destroy(&jobs->mutex);
+    *jobs = (JobSystem){0};
+}
+
+// Pushes a job to the queue of the calling thread, or runs it if there are no other workers to share it with
+void _JobPush(JobSystem* jobs, Job job) {
+    atomic_fetch_add_explicit(&job.counter->pending, 1, memory_order_relaxed);
+    if (jobs == NULL || jobs->worker_count == 1) {
+        _JobExecute(job);
+        return;
+    }
+
+    atomic_fetch_add(&jobs->queued, 1);  // Before the push, so it is never taken before it is counted
+    if (!_JobQueuePush(&jobs->queues[_job_worker_index], job)) {
+        atomic_fetch_sub(&jobs->queued, 1);
+        _JobExecute(job);
+    }
+}
+
+void JobSystemRun(JobSystem* jobs, JobFunction function, void* data, u32 first, u32 last, JobCounter* counter) {
+    _JobPush(jobs, (Job){.function = function, .data = data, .first = first, .last = last, .counter = counter});
+    if (jobs != NULL) { _JobWake(jobs, false); }
+}
+
+void JobSystemParallelFor(JobSystem* jobs, u32 count, u32 grain, JobFunction function, void* data, JobCounter* counter) {
+    grain = max(grain, 1);
+    JobSystem* shared = count > grain ? jobs : NULL;  // A single job is not worth sharing
+
+    for (u32 first = 0, last; first < count; first = last) {
+        last = first + min(grain, count - first);
+        _JobPush(shared, (Job){.function = function, .data = data, .first = first, .last = last, .counter = counter});
+    }
+    if (shared != NULL) { _JobWake(shared, true); }
+}
+
+void JobSystemWait(JobSystem* jobs, JobCounter* counter) {
+    while (atomic_load_explicit(&counter->pending, memory_order_acquire) > 0) {
+        Job job;
+        if (jobs != NULL && _JobTake(jobs, _job_worker_index, &job)) {
+            _JobExecute(job);
+        } else {
+            sched_yield();
+        }
+    }
+}
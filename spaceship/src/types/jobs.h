@@ -0,0 +1,111 @@
+#pragma once
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "types/arena.h"
+#include "types/types.h"
+
+#define JOB_MAX_WORKERS    16    // Threads of a job system, counting the one that starts it
+#define JOB_QUEUE_CAPACITY 1024  // Jobs waiting on the queue of every worker. Power of two. Jobs pushed to a full queue run right away
+#define JOB_SPIN_ROUNDS    64    // Failed rounds of stealing before an idle worker sleeps
+
+#define JobChunkCount(count, grain) (((count) + (grain) - 1) / (grain))  // Jobs a parallel for splits a range into
+#define JobChunkIndex(first, grain) ((first) / (grain))                  // Job of a parallel for that starts on an item
+
+/**
+ * Work of a job: a range of the items of its data.
+ */
+typedef void (*JobFunction)(void* data, u32 first, u32 last);
+
+/**
+ * Unfinished jobs of a group. Stages wait on the counter of the stages they depend on before they start.
+ */
+typedef struct JobCounter {
+    atomic_uint pending;
+} JobCounter;
+
+typedef struct Job {
+    JobFunction function;
+    void* data;
+    u32 first;  // First item of the range
+    u32 last;   // Item after the range
+    JobCounter* counter;
+} Job;
+
+/**
+ * Work-stealing deque of a worker. The owner pushes and pops jobs at the bottom, the other workers steal them from the top,
+ * so the owner works on the latest jobs while the oldest ones, usually the biggest, are taken away.
+ */
+typedef struct JobQueue {
+    struct JobSlot* slots;  // Ring buffer of the jobs
+    _Alignas(ARENA_CACHE_LINE_SIZE) atomic_llong top;
+    _Alignas(ARENA_CACHE_LINE_SIZE) atomic_llong bottom;
+} JobQueue;
+
+typedef struct JobWorker {
+    struct JobSystem* system;
+    u32 index;  // Index of the queue of the worker
+    pthread_t thread;
+    bool started;  // The thread is running. The first worker is the thread that started the system
+} JobWorker;
+
+/**
+ * Pool of worker threads running jobs. The thread that starts the system is the first worker: it runs jobs while it waits on them.
+ * Jobs are pushed from that thread or from other jobs.
+ */
+typedef struct JobSystem {
+    JobQueue queues[JOB_MAX_WORKERS];    // Queue of every worker
+    JobWorker workers[JOB_MAX_WORKERS];  // Threads of the workers. The first one is the thread that started the system
+    u32 worker_count;
+
+    atomic_bool running;
+    atomic_uint queued;    // Jobs pushed and not taken yet, so sleeping workers know when to wake up
+    atomic_uint sleeping;  // Workers waiting for jobs
+    pthread_mutex_t mutex;
+    pthread_cond_t wake;
+} JobSystem;
+
+/**
+ * Starts the worker threads of a job system on the calling thread.
+ * @param jobs Where to start the job system. Must not move until it is stopped.
+ * @param worker_count Workers, counting the calling thread. 0 to use one per processor. A single worker runs every job on the calling thread.
+ */
+void JobSystemStart(JobSystem* jobs, u32 worker_count);
+/**
+ * Stops the worker threads of a job system once their jobs are done.
+ * @param jobs Job system to stop.
+ */
+void JobSystemStop(JobSystem* jobs);
+
+/**
+ * Pushes a job.
+ * @param jobs Job system to use. NULL to run the job right away.
+ * @param function Work of the job.
+ * @param data Data of the job. Must stay valid until the job is done.
+ * @param first First item of the job.
+ * @param last Item after the last one of the job.
+ * @param counter Counter increased until the job is done.
+ */
+void JobSystemRun(JobSystem* jobs, JobFunction function, void* data, u32 first, u32 last, JobCounter* counter);
+/**
+ * Pushes the jobs of a range of items, split into consecutive chunks of the same size.
+ * The chunks do not depend on the workers, so the results of each one can be merged in `JobChunkIndex` order on every run.
+ * @param jobs Job system to use. NULL to run the jobs right away, in order.
+ * @param count Items of the range.
+ * @param grain Items of every job. The last job may get less.
+ * @param function Work of the jobs.
+ * @param data Data of the jobs. Must stay valid until the jobs are done.
+ * @param counter Counter increased until the jobs are done.
+ */
+void JobSystemParallelFor(JobSystem* jobs, u32 count, u32 grain, JobFunction function, void* data, JobCounter* counter);
+/**
+ * Runs jobs until every job of a counter is done.
+ * @param jobs Job system to use. NULL if the jobs were run right away.
+ * @param counter Counter to wait on.
+ */
+void JobSystemWait(JobSystem* jobs, JobCounter* counter);
+
+#endif  // JOBS_H
@@ -1,5 +1,6 @@
-
+#include <assert.h>
 #include <stdlib.h>
+#include <time.h>
 
 #include "types/object_pool.h"
 #include "utils/memory_utils.h"
@@ -10,59 +11,354 @@ usize _DuplicateToReachTarget(usize num, usize target) {
     return num;
 }
 
-void* _UpdateObjectFromObjectPool(void* object_pos, const void* const new_value, usize object_size) {
-    memory_copy(object_pos, new_value, object_size);
-    *((bool*)object_pos + object_size) = true;
-    return object_pos;
+f64 _ObjectPoolSeconds(void) {
+    struct timespec time;
+    timespec_get(&time, TIME_UTC);
+    return (f64)time.tv_sec + (f64)time.tv_nsec * 1e-9;
 }
 
-ObjectPool ObjectPoolCreate(usize object_size) { return ObjectPoolCreateCustom(object_size, DATA_OBJECT_POOL_DEFAULT_MEM_SIZE); }
+u32 _ObjectPoolOccupancyWords(usize chunks) { return (u32)((chunks + DATA_OBJECT_POOL_OCCUPANCY_WORD_BITS - 1) / DATA_OBJECT_POOL_OCCUPANCY_WORD_BITS); }
+
+void _ObjectPoolOccupancySet(ObjectPool* pool, u32 chunk_index) {
+    pool->occupancy[chunk_index / DATA_OBJECT_POOL_OCCUPANCY_WORD_BITS] |= (u64)1 << (chunk_index % DATA_OBJECT_POOL_OCCUPANCY_WORD_BITS);
+}
+
+void _ObjectPoolOccupancyUnset(ObjectPool* pool, u32 chunk_index) {
+    pool->occupancy[chunk_index / DATA_OBJECT_POOL_OCCUPANCY_WORD_BITS] &= ~((u64)1 << (chunk_index % DATA_OBJECT_POOL_OCCUPANCY_WORD_BITS));
+}
+
+void _ObjectPoolGenerationsInitialize(u16* generations, usize chunks) {
+    for (usize i = 0; i < chunks; ++i) { generations[i] = DATA_OBJECT_POOL_FIRST_GENERATION; }
+}
+
+// Invalidates every reference to the chunk. Generation 0 is skipped on wrap around
+void _ObjectPoolGenerationAdvance(ObjectPool* pool, u32 chunk_index) {
+    pool->generations[chunk_index] = (pool->generations[chunk_index] + 1) & DATA_OBJECT_POOL_REF_GENERATION_MASK;
+    if (pool->generations[chunk_index] == 0) { pool->generations[chunk_index] = DATA_OBJECT_POOL_FIRST_GENERATION; }
+}
+
+// Bookkeeping is never shrunk, so the generations of released chunks survive and their old references stay stale.
+// It at least doubles, as paged pools grow a page at a time and would copy it on every new page
+void _ObjectPoolBookkeepingResize(ObjectPool* pool) {
+    u32 old_capacity = pool->bookkeeping_capacity;
+    if (pool->chunk_capacity <= old_capacity) { return; }
+
+    u32 new_capacity = max(pool->chunk_capacity, old_capacity * 2);
+
+    u32 old_words = _ObjectPoolOccupancyWords(old_capacity);
+    u32 new_words = _ObjectPoolOccupancyWords(new_capacity);
+
+    if (new_words > old_words) {
+        pool->occupancy = (u64*)realloc(pool->occupancy, sizeof(u64) * new_words);
+        memory_zero(pool->occupancy + old_words, sizeof(u64) * (new_words - old_words));
+    }
+
+    pool->generations = (u16*)realloc(pool->generations, sizeof(u16) * new_capacity);
+    _ObjectPoolGenerationsInitialize(pool->generations + old_capacity, new_capacity - old_capacity);
+
+    pool->bookkeeping_capacity = new_capacity;
+}
+
+// Contiguous pools double their only page, moving every object to the new memory
+void _ObjectPoolGrowContiguous(ObjectPool* pool) {
+    pool->mem_size = _DuplicateToReachTarget(pool->mem_size, pool->chunk_size * (pool->chunk_count + 1));
+    pool->pages[0] = (byte*)realloc(pool->pages[0], pool->mem_size);
+    pool->chunk_capacity = (u32)(pool->mem_size / pool->chunk_size);
+}
+
+// Paged pools append a new page to the page table, so the objects already in the pool never move
+void _ObjectPoolGrowPaged(ObjectPool* pool) {
+    usize page_size = pool->chunk_size << pool->page_shift;
+
+    if ((pool->page_count & (pool->page_count - 1)) == 0) {  // Page table is full when the page count reaches a power of 2
+        pool->pages = (byte**)realloc(pool->pages, sizeof(byte*) * pool->page_count * 2);
+    }
+    pool->pages[pool->page_count++] = (byte*)malloc(page_size);
+
+    pool->mem_size += page_size;
+    pool->chunk_capacity += 1u << pool->page_shift;
+}
+
+u32 ObjectPoolChunkAcquire(ObjectPool* pool) {
+    u32 chunk_index = pool->free_chunk;
+
+    if (chunk_index != DATA_OBJECT_POOL_NO_FREE_CHUNK) {
+        pool->free_chunk = *(u32*)ObjectPoolChunkAt(pool, chunk_index);
+    } else {
+        if (pool->chunk_count == pool->chunk_capacity) {
+            f64 grow_start = _ObjectPoolSeconds();
+
+            if (ObjectPoolIsPaged(pool)) {
+                _ObjectPoolGrowPaged(pool);
+            } else {
+                _ObjectPoolGrowContiguous(pool);
+            }
+            _ObjectPoolBookkeepingResize(pool);
+
+            ObjectPoolStats* stats = &pool->stats;
+            stats->grow_time_last = _ObjectPoolSeconds() - grow_start;
+            stats->grow_time_max = max(stats->grow_time_max, stats->grow_time_last);
+            stats->grow_time_total += stats->grow_time_last;
+            ++stats->grow_count;
+        }
+
+        assert(pool->chunk_count <= DATA_OBJECT_POOL_REF_INDEX_MASK && "Chunks do not fit on the index of the references");
+        chunk_index = pool->chunk_count++;
+        pool->stats.peak_chunk_count = max(pool->stats.peak_chunk_count, pool->chunk_count);
+    }
+
+    _ObjectPoolOccupancySet(pool, chunk_index);
+    ++pool->object_count;
+
+    ++pool->stats.frame_adds;
+    ++pool->stats.total_adds;
+    pool->stats.peak_object_count = max(pool->stats.peak_object_count, pool->object_count);
+    return chunk_index;
+}
+
+ObjectPoolRef _ObjectPoolRefCreate(const ObjectPool* pool, u32 chunk_index) {
+    return (ObjectPoolRef){((u32)pool->generations[chunk_index] << DATA_OBJECT_POOL_REF_INDEX_BITS) | chunk_index};
+}
+
+ObjectPool _ObjectPoolCreateWithPage(usize chunk_size, usize object_size, u8 page_shift, usize page_size, u32 chunk_capacity) {
+    byte** pages = reserve_a(byte*, 1);
+    pages[0] = (byte*)malloc(page_size);
+
+    u16* generations = reserve_a(u16, chunk_capacity);
+    _ObjectPoolGenerationsInitialize(generations, chunk_capacity);
 
-ObjectPool ObjectPoolCreateCustom(usize object_size, usize initial_mem_size) {
     return (ObjectPool){.chunk_count = 0,
                         .object_count = 0,
+                        .chunk_capacity = chunk_capacity,
+                        .bookkeeping_capacity = chunk_capacity,
                         .object_size = object_size,
-                        .chunks = (byte*)malloc(initial_mem_size),
-                        .chunk_size = object_size + sizeof(bool),
-                        .mem_size = initial_mem_size};
+                        .chunk_size = chunk_size,
+                        .mem_size = page_size,
+                        .pages = pages,
+                        .page_count = 1,
+                        .page_shift = page_shift,
+                        .occupancy = reserve_zero_a(u64, _ObjectPoolOccupancyWords(chunk_capacity)),
+                        .generations = generations,
+                        .free_chunk = DATA_OBJECT_POOL_NO_FREE_CHUNK,
+                        .remaps = NULL,
+                        .remap_count = 0,
+                        .remap_capacity = 0,
+                        .stats = {0}};
 }
 
-void ObjectPoolDelete(ObjectPool* pool) { free(pool->chunks); }
+// Dead chunks store the index of the next free chunk in place of the object.
+// `sizeof` of any type is a multiple of its alignment, so the objects are packed at their natural alignment.
+usize _ObjectPoolChunkSize(usize object_size) { return max(object_size, sizeof(u32)); }
+
+ObjectPool ObjectPoolCreate(usize object_size) { return ObjectPoolCreateCustom(object_size, DATA_OBJECT_POOL_DEFAULT_MEM_SIZE); }
+
+ObjectPool ObjectPoolCreateCustom(usize object_size, usize initial_mem_size) {
+    usize chunk_size = _ObjectPoolChunkSize(object_size);
+    initial_mem_size = max(initial_mem_size, chunk_size);
+
+    return _ObjectPoolCreateWithPage(
+        chunk_size, object_size, DATA_OBJECT_POOL_CONTIGUOUS_PAGE_SHIFT, initial_mem_size, (u32)(initial_mem_size / chunk_size));
+}
+
+ObjectPool ObjectPoolCreatePaged(usize object_size, u32 page_chunks) {
+    usize chunk_size = _ObjectPoolChunkSize(object_size);
+
+    u8 page_shift = 0;
+    while ((1u << page_shift) < max(page_chunks, DATA_OBJECT_POOL_OCCUPANCY_WORD_BITS)) { ++page_shift; }
+
+    return _ObjectPoolCreateWithPage(chunk_size, object_size, page_shift, chunk_size << page_shift, 1u << page_shift);
+}
+
+void ObjectPoolDelete(ObjectPool* pool) {
+    for (u32 i = 0; i < pool->page_count; ++i) { free(pool->pages[i]); }
+    free(pool->pages);
+    free(pool->occupancy);
+    free(pool->generations);
+    free(pool->remaps);
+}
 
 void* ObjectPoolObjectAdd(ObjectPool* pool, const void* const data) {
-    ForEachObjectPoolChunk(pool, void, iteration) {
-        if (!iteration.valid) {
-            _UpdateObjectFromObjectPool(iteration.object, data, pool->object_size);
-            ++pool->object_count;
-            return iteration.object;
+    u32 chunk_index = ObjectPoolChunkAcquire(pool);
+    return memory_copy(ObjectPoolChunkAt(pool, chunk_index), data, pool->object_size);
+}
+
+ObjectPoolRef ObjectPoolObjectAddRef(ObjectPool* pool, const void* const data) {
+    u32 chunk_index = ObjectPoolChunkAcquire(pool);
+    memory_copy(ObjectPoolChunkAt(pool, chunk_index), data, pool->object_size);
+    return _ObjectPoolRefCreate(pool, chunk_index);
+}
+
+void ObjectPoolObjectRemove(ObjectPool* pool, u32 object_index) {
+    if (ObjectPoolChunkIsValid(pool, object_index)) {
+        _ObjectPoolOccupancyUnset(pool, object_index);
+        _ObjectPoolGenerationAdvance(pool, object_index);
+        *(u32*)ObjectPoolChunkAt(pool, object_index) = pool->free_chunk;
+        pool->free_chunk = object_index;
+        --pool->object_count;
+
+        ++pool->stats.frame_removes;
+        ++pool->stats.total_removes;
+    }
+}
+
+void* ObjectPoolObjectAt(ObjectPool pool, u32 object_index) {
+    return ObjectPoolChunkIsValid(&pool, object_index) ? ObjectPoolChunkAt(&pool, object_index) : NULL;
+}
+
+ObjectPoolRef ObjectPoolRefAt(const ObjectPool* pool, u32 object_index) {
+    return ObjectPoolChunkIsValid(pool, object_index) ? _ObjectPoolRefCreate(pool, object_index) : DATA_OBJECT_POOL_REF_NULL;
+}
+
+void* ObjectPoolResolve(const ObjectPool* pool, ObjectPoolRef ref) {
+    u32 chunk_index = ObjectPoolRefIndex(ref);
+    if (chunk_index < pool->chunk_count && pool->generations[chunk_index] == ref.handle >> DATA_OBJECT_POOL_REF_INDEX_BITS) {
+        return ObjectPoolChunkAt(pool, chunk_index);
+    }
+    return NULL;
+}
+
+void ObjectPoolRefRemove(ObjectPool* pool, ObjectPoolRef ref) {
+    if (ObjectPoolResolve(pool, ref) != NULL) { ObjectPoolObjectRemove(pool, ObjectPoolRefIndex(ref)); }
+}
+
+// Index of the first dead chunk from the specified index, or the chunk count if there are none
+u32 _ObjectPoolNextDeadChunk(const ObjectPool* pool, u32 chunk_index) {
+    if (chunk_index >= pool->chunk_count) { return pool->chunk_count; }
+
+    u32 word = chunk_index / DATA_OBJECT_POOL_OCCUPANCY_WORD_BITS;
+    u32 last_word = (pool->chunk_count - 1) / DATA_OBJECT_POOL_OCCUPANCY_WORD_BITS;
+    u64 bits = ~pool->occupancy[word] & (~(u64)0 << (chunk_index % DATA_OBJECT_POOL_OCCUPANCY_WORD_BITS));
+
+    while (bits == 0) {
+        if (++word > last_word) { return pool->chunk_count; }
+        bits = ~pool->occupancy[word];
+    }
+    return min(word * DATA_OBJECT_POOL_OCCUPANCY_WORD_BITS + (u32)__builtin_ctzll(bits), pool->chunk_count);
+}
+
+// Index of the last valid chunk up to the specified index, or DATA_OBJECT_POOL_NO_FREE_CHUNK if there are none
+u32 _ObjectPoolPreviousValidChunk(const ObjectPool* pool, u32 chunk_index) {
+    if (pool->chunk_count == 0) { return DATA_OBJECT_POOL_NO_FREE_CHUNK; }
+    chunk_index = min(chunk_index, pool->chunk_count - 1);
+
+    i64 word = chunk_index / DATA_OBJECT_POOL_OCCUPANCY_WORD_BITS;
+    u32 shift = DATA_OBJECT_POOL_OCCUPANCY_WORD_BITS - 1 - (chunk_index % DATA_OBJECT_POOL_OCCUPANCY_WORD_BITS);
+    u64 bits = pool->occupancy[word] & (~(u64)0 >> shift);
+
+    while (bits == 0) {
+        if (--word < 0) { return DATA_OBJECT_POOL_NO_FREE_CHUNK; }
+        bits = pool->occupancy[word];
+    }
+    return (u32)word * DATA_OBJECT_POOL_OCCUPANCY_WORD_BITS + (DATA_OBJECT_POOL_OCCUPANCY_WORD_BITS - 1 - (u32)__builtin_clzll(bits));
+}
+
+void _ObjectPoolRemapRecord(ObjectPool* pool, ObjectPoolRef from, ObjectPoolRef to) {
+    if (pool->remap_count == pool->remap_capacity) {
+        pool->remap_capacity = max(pool->remap_capacity * 2, DATA_OBJECT_POOL_OCCUPANCY_WORD_BITS);
+        pool->remaps = (ObjectPoolRemap*)realloc(pool->remaps, sizeof(ObjectPoolRemap) * pool->remap_capacity);
+    }
+    pool->remaps[pool->remap_count++] = (ObjectPoolRemap){.from = from, .to = to};
+}
+
+// Releases the memory past the last chunk in use. Paged pools keep at least one page
+void _ObjectPoolShrink(ObjectPool* pool) {
+    if (ObjectPoolIsPaged(pool)) {
+        u32 needed_pages = max(1, (pool->chunk_count + (1u << pool->page_shift) - 1) >> pool->page_shift);
+        while (pool->page_count > needed_pages) { free(pool->pages[--pool->page_count]); }
+
+        pool->chunk_capacity = pool->page_count << pool->page_shift;
+        pool->mem_size = (usize)pool->page_count * (pool->chunk_size << pool->page_shift);
+    } else {
+        usize needed_size = max(pool->chunk_count, 1) * pool->chunk_size;
+        usize mem_size = pool->mem_size;
+        while (mem_size / 2 >= needed_size) { mem_size /= 2; }
+
+        if (mem_size != pool->mem_size) {
+            pool->pages[0] = (byte*)realloc(pool->pages[0], mem_size);
+            pool->mem_size = mem_size;
+            pool->chunk_capacity = (u32)(mem_size / pool->chunk_size);
         }
     }
+}
+
+u32 ObjectPoolCompact(ObjectPool* pool, u32 budget, bool shrink) {
+    pool->remap_count = 0;
+
+    u32 moves = 0;
+    u32 hole = _ObjectPoolNextDeadChunk(pool, 0);
+    u32 last = _ObjectPoolPreviousValidChunk(pool, pool->chunk_count);
+
+    while (moves < budget && last != DATA_OBJECT_POOL_NO_FREE_CHUNK && hole < last) {
+        ObjectPoolRef from = _ObjectPoolRefCreate(pool, last);
+
+        memory_copy(ObjectPoolChunkAt(pool, hole), ObjectPoolChunkAt(pool, last), pool->object_size);
+        _ObjectPoolOccupancySet(pool, hole);
+        _ObjectPoolOccupancyUnset(pool, last);
+        _ObjectPoolGenerationAdvance(pool, last);
+
+        _ObjectPoolRemapRecord(pool, from, _ObjectPoolRefCreate(pool, hole));
+        ++moves;
+
+        hole = _ObjectPoolNextDeadChunk(pool, hole + 1);
+        last = _ObjectPoolPreviousValidChunk(pool, last);
+    }
 
-    usize current_size = pool->chunk_count * pool->chunk_size;
-    usize needed_size = pool->chunk_size + current_size;
+    // Trailing dead chunks are dropped and the free list is rebuilt with the remaining holes, lowest index first
+    pool->chunk_count = last == DATA_OBJECT_POOL_NO_FREE_CHUNK ? 0 : last + 1;
+    pool->free_chunk = DATA_OBJECT_POOL_NO_FREE_CHUNK;
 
-    if (pool->mem_size < needed_size) {
-        pool->mem_size = _DuplicateToReachTarget(pool->mem_size, needed_size);
-        pool->chunks = (byte*)realloc(pool->chunks, pool->mem_size);
+    u32 free_tail = DATA_OBJECT_POOL_NO_FREE_CHUNK;
+    for (u32 dead = _ObjectPoolNextDeadChunk(pool, 0); dead < pool->chunk_count; dead = _ObjectPoolNextDeadChunk(pool, dead + 1)) {
+        *(u32*)ObjectPoolChunkAt(pool, dead) = DATA_OBJECT_POOL_NO_FREE_CHUNK;
+        if (free_tail == DATA_OBJECT_POOL_NO_FREE_CHUNK) {
+            pool->free_chunk = dead;
+        } else {
+            *(u32*)ObjectPoolChunkAt(pool, free_tail) = dead;
+        }
+        free_tail = dead;
     }
 
-    void* last_data_object = pool->chunks + current_size;
-    _UpdateObjectFromObjectPool(last_data_object, data, pool->object_size);
-    pool->object_count = ++pool->chunk_count;
-    return last_data_object;
+    if (shrink) { _ObjectPoolShrink(pool); }
+
+    return moves;
 }
 
-void ObjectPoolObjectRemove(ObjectPool* pool, u32 object_index) {
-    bool* is_used = (bool*)pool->chunks + (pool->chunk_size * object_index) + pool->object_size;
-    if (*is_used) {
-        *is_used = false;
-        --pool->object_count;
+ObjectPoolRef ObjectPoolRefRemap(const ObjectPool* pool, ObjectPoolRef ref) {
+    // Data objects are moved from the back of the pool, so the remap table is sorted by descending source index
+    u32 index = ObjectPoolRefIndex(ref);
+    u32 low = 0, high = pool->remap_count;
+
+    while (low < high) {
+        u32 middle = low + (high - low) / 2;
+        u32 middle_index = ObjectPoolRefIndex(pool->remaps[middle].from);
+
+        if (middle_index == index) {
+            return ObjectPoolRefEquals(pool->remaps[middle].from, ref) ? pool->remaps[middle].to : ref;
+        } else if (middle_index > index) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
     }
+    return ref;
 }
 
-void* ObjectPoolObjectAt(ObjectPool pool, u32 object_index) {
-    void* data_object = pool.chunks + (pool.chunk_size * object_index);
-    return *((bool*)data_object + pool.object_size) ? data_object : NULL;
+ObjectPoolStats ObjectPoolStatsGet(const ObjectPool* pool) { return pool->stats; }
+
+void ObjectPoolStatsFrameReset(ObjectPool* pool) {
+    pool->stats.frame_adds = 0;
+    pool->stats.frame_removes = 0;
+}
+
+usize ObjectPoolBytesReserved(const ObjectPool* pool) {
+    return pool->mem_size + sizeof(byte*) * pool->page_count + sizeof(u64) * _ObjectPoolOccupancyWords(pool->bookkeeping_capacity) +
+           sizeof(u16) * pool->bookkeeping_capacity + sizeof(ObjectPoolRemap) * pool->remap_capacity;
+}
+
+usize ObjectPoolBytesUsed(const ObjectPool* pool) { return pool->object_size * pool->object_count; }
+
+f32 ObjectPoolFragmentation(const ObjectPool* pool) {
+    return pool->chunk_count == 0 ? 0 : (f32)(pool->chunk_count - pool->object_count) / (f32)pool->chunk_count;
 }
 
 u32 ObjectPoolObjectCount(ObjectPool pool) { return pool.object_count; }
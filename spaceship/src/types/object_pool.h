@@ -4,20 +4,73 @@
 
 #include "types/types.h"
 
-#define DATA_OBJECT_POOL_DEFAULT_MEM_SIZE 1024
+#define DATA_OBJECT_POOL_DEFAULT_MEM_SIZE      1024
+#define DATA_OBJECT_POOL_DEFAULT_PAGE_CHUNKS   256
+#define DATA_OBJECT_POOL_CONTIGUOUS_PAGE_SHIFT 31          // Page shift of contiguous pools, every valid chunk index lands on the first page
+#define DATA_OBJECT_POOL_NO_FREE_CHUNK         UINT32_MAX  // Free list terminator
+#define DATA_OBJECT_POOL_OCCUPANCY_WORD_BITS   64          // Chunks tracked by each occupancy word
+
+#define DATA_OBJECT_POOL_REF_INDEX_BITS       20                                                    // Bits of a reference used by the chunk index
+#define DATA_OBJECT_POOL_REF_INDEX_MASK       ((1u << DATA_OBJECT_POOL_REF_INDEX_BITS) - 1)         // Mask of the chunk index of a reference
+#define DATA_OBJECT_POOL_REF_GENERATION_MASK  ((1u << (32 - DATA_OBJECT_POOL_REF_INDEX_BITS)) - 1)  // Mask of the generation of a chunk, wrapped around past it
+#define DATA_OBJECT_POOL_FIRST_GENERATION     1                                                     // Generation 0 is reserved for the null reference
+
+/**
+ * Generational reference to a data object of an object pool.
+ * Packs the chunk index in the lower bits and the chunk generation in the upper ones,
+ * so references to removed data objects are detected even after their chunk is reused.
+ */
+typedef struct {
+    u32 handle;
+} ObjectPoolRef;
+
+/**
+ * Data object moved by a compaction pass of an object pool.
+ */
+typedef struct {
+    ObjectPoolRef from;  // Reference to the data object before being moved. Stale after the move
+    ObjectPoolRef to;    // Reference to the data object after being moved
+} ObjectPoolRemap;
+
+/**
+ * Usage counters of an object pool. Only increments and comparisons on the hot paths, so they are always enabled.
+ */
+typedef struct {
+    u32 frame_adds;         // Data objects added since the last frame reset
+    u32 frame_removes;      // Data objects removed since the last frame reset
+    u64 total_adds;         // Data objects added since the creation of the pool
+    u64 total_removes;      // Data objects removed since the creation of the pool
+    u32 peak_object_count;  // Highest number of valid data objects
+    u32 peak_chunk_count;   // Highest number of chunks in use
+    u32 grow_count;         // Times the pool reserved more memory
+    f64 grow_time_last;     // Seconds spent on the last memory reservation
+    f64 grow_time_max;      // Seconds spent on the slowest memory reservation
+    f64 grow_time_total;    // Seconds spent on all the memory reservations
+} ObjectPoolStats;
 
 typedef struct {
     u32 chunk_count;
     u32 object_count;
+    u32 chunk_capacity;
+    u32 bookkeeping_capacity;  // Chunks covered by the occupancy and generations arrays
     usize object_size;
-    byte* chunks;
     usize chunk_size;
     usize mem_size;
+    byte** pages;      // Page table. Contiguous pools use a single page that is reallocated when it grows
+    u32 page_count;
+    u8 page_shift;     // Chunks per page as a power of 2
+    u64* occupancy;    // Bitmap of the chunks with valid objects
+    u16* generations;  // Generation of every chunk, increased every time its object is removed
+    u32 free_chunk;    // Head of the free list threaded through the dead chunks
+
+    ObjectPoolRemap* remaps;  // Data objects moved by the last compaction pass
+    u32 remap_count;
+    u32 remap_capacity;
+
+    ObjectPoolStats stats;
 } ObjectPool;
 
-typedef struct {
-    usize chunk;
-} ObjectPoolRef;
+#define DATA_OBJECT_POOL_REF_NULL ((ObjectPoolRef){0})  // Reference that never resolves to a data object
 
 /**
  * Creates an data object pool.
@@ -45,6 +98,21 @@ ObjectPool ObjectPoolCreateCustom(usize object_size, usize initial_mem_size);
  * @return New data object pool.
  */
 #define ObjectPoolCreateCustomType(type, initial_stack_size) ObjectPoolCreateCustom(sizeof(type), initial_stack_size)
+/**
+ * Creates a paged data object pool.
+ * Memory is reserved in fixed-size pages added on demand to a page table, so the pool never moves its data objects when it grows.
+ * @param object_size Size of the entities to contain.
+ * @param page_chunks Number of chunks per page. Rounded up to a power of 2 of at least 64 chunks.
+ * @return New data object pool.
+ */
+ObjectPool ObjectPoolCreatePaged(usize object_size, u32 page_chunks);
+/**
+ * Creates a paged data object pool of an specific type.
+ * @param type Type of the data object to contain.
+ * @param page_chunks Number of chunks per page.
+ * @return New data object pool.
+ */
+#define ObjectPoolCreatePagedType(type, page_chunks) ObjectPoolCreatePaged(sizeof(type), page_chunks)
 /**
  * Deletes an data object pool.
  * @param pool Entity pool to delete.
@@ -53,13 +121,30 @@ void ObjectPoolDelete(ObjectPool* pool);
 
 /**
  * Adds an data object to an data object pool.
+ * Reuses the last freed chunk if there is any, so the operation is O(1).
+ * The returned pointer of a contiguous pool is invalidated whenever the pool grows, use `ObjectPoolObjectAddRef` to keep a reference to the data object.
  * @param pool Entity pool to use.
  * @param data object Reference to the memory that contains the data object to include (as a shallow copy) into the data object pool.
  * @return Reference to the new data object inside the memory pool.
  */
 void* ObjectPoolObjectAdd(ObjectPool* pool, const void* const data);
+/**
+ * Adds an data object to an data object pool.
+ * @param pool Entity pool to use.
+ * @param data object Reference to the memory that contains the data object to include (as a shallow copy) into the data object pool.
+ * @return Generational reference to the new data object.
+ */
+ObjectPoolRef ObjectPoolObjectAddRef(ObjectPool* pool, const void* const data);
+/**
+ * Reserves a chunk for a new data object without writing it.
+ * Meant for typed pools, which write the data object themselves.
+ * @param pool Entity pool to use.
+ * @return Index of the reserved chunk, already marked as valid.
+ */
+u32 ObjectPoolChunkAcquire(ObjectPool* pool);
 /**
  * Removes the data object at the specified index from the data object pool.
+ * The chunk is pushed into the free list to be reused by the next addition.
  * @param pool Entity pool to use.
  * @param object_index Index of the data object to remove.
  */
@@ -79,6 +164,67 @@ void* ObjectPoolObjectAt(ObjectPool pool, u32 object_index);
  * @return Retrieved data object casted to type or NULL if no chunk at the specified index or the data object is invalid.
  */
 #define ObjectPoolObjectTypeAt(pool, type, object_index) ((type*)ObjectPoolObjectAt(pool, object_index))
+/**
+ * Retrieves a generational reference to the data object at the specified index.
+ * @param pool Entity pool to use.
+ * @param object_index Index of the data object to reference.
+ * @return Reference to the data object or `DATA_OBJECT_POOL_REF_NULL` if the data object is invalid.
+ */
+ObjectPoolRef ObjectPoolRefAt(const ObjectPool* pool, u32 object_index);
+/**
+ * Retrieves the data object pointed by a generational reference.
+ * @param pool Entity pool to use.
+ * @param ref Reference to the data object.
+ * @return Referenced data object or NULL if it has been removed from the data object pool.
+ */
+void* ObjectPoolResolve(const ObjectPool* pool, ObjectPoolRef ref);
+/**
+ * Retrieves the data object pointed by a generational reference as a given type.
+ * @param pool Entity pool to use.
+ * @param type Type of the data object.
+ * @param ref Reference to the data object.
+ * @return Referenced data object casted to type or NULL if it has been removed from the data object pool.
+ */
+#define ObjectPoolTypeResolve(pool, type, ref) ((type*)ObjectPoolResolve(pool, ref))
+/**
+ * Removes the data object pointed by a generational reference. Does nothing if the reference is stale.
+ * @param pool Entity pool to use.
+ * @param ref Reference to the data object to remove.
+ */
+void ObjectPoolRefRemove(ObjectPool* pool, ObjectPoolRef ref);
+/**
+ * Retrieves the chunk index of a generational reference.
+ * @param ref Reference to check.
+ * @return Index of the referenced chunk.
+ */
+#define ObjectPoolRefIndex(ref) ((ref).handle & DATA_OBJECT_POOL_REF_INDEX_MASK)
+/**
+ * Checks if two generational references point to the same data object.
+ * @param a First reference.
+ * @param b Second reference.
+ * @return True if both references are the same.
+ */
+#define ObjectPoolRefEquals(a, b) ((a).handle == (b).handle)
+
+/**
+ * Moves valid data objects from the back of the pool into the dead chunks at the front, then drops the trailing dead chunks.
+ * Meant to be called once per frame so the pool is compacted incrementally after a spike of data objects.
+ * Every moved data object is recorded into the remap table of the pool (replaced on every call), so references and
+ * indices held elsewhere can be fixed up with `ObjectPoolRefRemap` or by reading `pool->remaps` directly.
+ * @param pool Entity pool to compact.
+ * @param budget Maximum number of data objects to move.
+ * @param shrink Whether to release the memory past the last chunk in use.
+ * @return Number of data objects moved.
+ */
+u32 ObjectPoolCompact(ObjectPool* pool, u32 budget, bool shrink);
+/**
+ * Updates a generational reference to a data object moved by the last compaction pass.
+ * @param pool Entity pool to use.
+ * @param ref Reference to update.
+ * @return Reference to the new location of the data object, or the same reference if it was not moved.
+ */
+ObjectPoolRef ObjectPoolRefRemap(const ObjectPool* pool, ObjectPoolRef ref);
+
 /**
  * Retrieves the number of entities inside the data object pool.
  * @param pool Entity pool to check.
@@ -92,6 +238,82 @@ u32 ObjectPoolObjectCount(ObjectPool pool);
  */
 u32 ObjectPoolChunkCount(ObjectPool pool);
 
+/**
+ * Retrieves the usage counters of a data object pool.
+ * @param pool Entity pool to check.
+ * @return Usage counters of the pool.
+ */
+ObjectPoolStats ObjectPoolStatsGet(const ObjectPool* pool);
+/**
+ * Resets the per-frame usage counters of a data object pool. Call once at the start of every frame.
+ * @param pool Entity pool to use.
+ */
+void ObjectPoolStatsFrameReset(ObjectPool* pool);
+/**
+ * Retrieves the bytes reserved by a data object pool, including its bookkeeping.
+ * @param pool Entity pool to check.
+ * @return Reserved bytes.
+ */
+usize ObjectPoolBytesReserved(const ObjectPool* pool);
+/**
+ * Retrieves the bytes used by the valid data objects of a data object pool.
+ * @param pool Entity pool to check.
+ * @return Used bytes.
+ */
+usize ObjectPoolBytesUsed(const ObjectPool* pool);
+/**
+ * Retrieves the fragmentation of a data object pool, as the ratio of dead chunks among the chunks in use.
+ * @param pool Entity pool to check.
+ * @return Fragmentation in the range [0..1].
+ */
+f32 ObjectPoolFragmentation(const ObjectPool* pool);
+
+/**
+ * Checks if a data object pool stores its chunks in fixed-size pages.
+ * @param pool Entity pool to check.
+ * @return True if the pool is paged.
+ */
+static inline bool ObjectPoolIsPaged(const ObjectPool* pool) { return pool->page_shift != DATA_OBJECT_POOL_CONTIGUOUS_PAGE_SHIFT; }
+/**
+ * Retrieves the memory of the chunk at the specified index, no matter if it contains a valid data object.
+ * @param pool Entity pool to use.
+ * @param chunk_index Index of the chunk. Must be lower than the chunk capacity of the pool.
+ * @return Memory of the chunk.
+ */
+static inline void* ObjectPoolChunkAt(const ObjectPool* pool, u32 chunk_index) {
+    return pool->pages[chunk_index >> pool->page_shift] + pool->chunk_size * (chunk_index & ((1u << pool->page_shift) - 1));
+}
+/**
+ * Checks if the chunk at the specified index contains a valid data object.
+ * @param pool Entity pool to check.
+ * @param chunk_index Index of the chunk.
+ * @return True if the chunk contains a valid data object.
+ */
+static inline bool ObjectPoolChunkIsValid(const ObjectPool* pool, u32 chunk_index) {
+    return chunk_index < pool->chunk_count &&
+           (pool->occupancy[chunk_index / DATA_OBJECT_POOL_OCCUPANCY_WORD_BITS] >> (chunk_index % DATA_OBJECT_POOL_OCCUPANCY_WORD_BITS)) & 1;
+}
+/**
+ * Retrieves the index of the first chunk with a valid data object starting from the specified index.
+ * Empty occupancy words are skipped as a whole, so sparse pools are traversed in time proportional to their valid data objects.
+ * @param pool Entity pool to check.
+ * @param chunk_index Index of the first chunk to check.
+ * @return Index of the chunk with a valid data object or the chunk count of the pool if there are no more.
+ */
+static inline u32 ObjectPoolNextValidChunk(const ObjectPool* pool, u32 chunk_index) {
+    if (chunk_index >= pool->chunk_count) { return pool->chunk_count; }
+
+    u32 word = chunk_index / DATA_OBJECT_POOL_OCCUPANCY_WORD_BITS;
+    u32 last_word = (pool->chunk_count - 1) / DATA_OBJECT_POOL_OCCUPANCY_WORD_BITS;
+    u64 bits = pool->occupancy[word] & (~(u64)0 << (chunk_index % DATA_OBJECT_POOL_OCCUPANCY_WORD_BITS));
+
+    while (bits == 0) {
+        if (++word > last_word) { return pool->chunk_count; }
+        bits = pool->occupancy[word];
+    }
+    return word * DATA_OBJECT_POOL_OCCUPANCY_WORD_BITS + (u32)__builtin_ctzll(bits);
+}
+
 /**
  * Custom for-each-loop to iterate over all the chunks of an data object pool.
  * Just define a block of code just like a for-loop to execute for every chunk.
@@ -105,33 +327,32 @@ u32 ObjectPoolChunkCount(ObjectPool pool);
  *
  * Usage:
  * ```
- * ObjectPool pool = EntityPoolCreateType(float);
+ * ObjectPool pool = ObjectPoolCreateType(float);
  *
- * float f;
- * ObjectPoolObjectAdd(&pool, &(f = 1.0f));
- * ObjectPoolObjectAdd(&pool, &(f = 6.7f));
+ * ObjectPoolObjectAdd(&pool, &(float){1.0f});
+ * ObjectPoolObjectAdd(&pool, &(float){6.7f});
  *
- * ForEachObjectPoolChunk(pool, float, itr) {
- *     printf("Iteration: %d. Entity: %.2f [%p]. %s\n", itr.index, *itr.data, itr.object, itr.is_used ? "Is alive :)" : "Is dead :(");
+ * ForEachObjectPoolChunk(&pool, float, itr) {
+ *     printf("Iteration: %u. Entity: %.2f [%p]. %s\n", itr.index, *itr.object, (void*)itr.object, itr.valid ? "Is alive :)" : "Is dead :(");
  * }
  * ```
  */
-#define ForEachObjectPoolChunk(pool, type, iteration_var)                                                 \
-    if ((pool)->chunk_count > 0)                                                                          \
-        for (                                                                                             \
-            struct {                                                                                      \
-                u32 index;                                                                                \
-                type* object;                                                                             \
-                bool valid;                                                                               \
-            } iteration_var = {0, (type*)(pool)->chunks, *(bool*)((pool)->chunks + (pool)->object_size)}; \
-            iteration_var.index < (pool)->chunk_count;                                                    \
-            ++iteration_var.index,                                                                        \
-              iteration_var.object = (type*)((uptr)iteration_var.object + (pool)->chunk_size),            \
-              iteration_var.valid = *(bool*)((uptr)iteration_var.object + (pool)->object_size))
+#define ForEachObjectPoolChunk(pool, type, iteration_var)                                              \
+    for (                                                                                              \
+        struct {                                                                                       \
+            u32 index;                                                                                 \
+            type* object;                                                                              \
+            bool valid;                                                                                \
+        } iteration_var = {0, (type*)ObjectPoolChunkAt((pool), 0), ObjectPoolChunkIsValid((pool), 0)}; \
+        iteration_var.index < (pool)->chunk_count;                                                     \
+        ++iteration_var.index,                                                                         \
+          iteration_var.object = (type*)ObjectPoolChunkAt((pool), iteration_var.index),                \
+          iteration_var.valid = ObjectPoolChunkIsValid((pool), iteration_var.index))
 
 /**
  * Custom for-each-loop to iterate over all the chunks with valid entities of an data object pool.
  * Just define a block of code just like a for-loop to execute for every chunk with valid entities.
+ * Chunks are visited in index order, so paged pools are traversed page by page.
  *
  * @param pool Entity pool to use.
  * @param type Type of the data object.
@@ -141,26 +362,97 @@ u32 ObjectPoolChunkCount(ObjectPool pool);
  *
  * Usage:
  * ```
- * ObjectPool pool = EntityPoolCreateType(float);
+ * ObjectPool pool = ObjectPoolCreateType(float);
+ *
+ * ObjectPoolObjectAdd(&pool, &(float){1.0f});
+ * ObjectPoolObjectAdd(&pool, &(float){6.7f});
+ *
+ * ForEachObjectPoolObject(&pool, float, itr) {
+ *     printf("Iteration: %u. Entity: %.2f [%p]\n", itr.index, *itr.object, (void*)itr.object);
+ * }
+ * ```
+ */
+#define ForEachObjectPoolObject(pool, type, iteration_var)                              \
+    for (                                                                               \
+        struct {                                                                        \
+            u32 index;                                                                  \
+            type* object;                                                               \
+        } iteration_var = {ObjectPoolNextValidChunk((pool), 0), NULL};                  \
+        iteration_var.index < (pool)->chunk_count &&                                    \
+        (iteration_var.object = (type*)ObjectPoolChunkAt((pool), iteration_var.index)); \
+        iteration_var.index = ObjectPoolNextValidChunk((pool), iteration_var.index + 1))
+
+/**
+ * Defines a paged data object pool specialized for a type, named `<type>Pool`.
+ * Element size and alignment are compile-time constants, so the accessors compile down to a shift, a mask and a scaled index,
+ * and data objects are written with typed assignments instead of byte copies.
+ * Bookkeeping (free list, occupancy, generations, compaction) is shared with the generic pool stored in `base`.
  *
- * float f;
- * ObjectPoolObjectAdd(&pool, &(f = 1.0f));
- * ObjectPoolObjectAdd(&pool, &(f = 6.7f));
+ * Generated functions:
+ * - `<type>Pool <type>PoolCreate(u32 page_chunks)`
+ * - `void <type>PoolDelete(<type>Pool* pool)`
+ * - `type* <type>PoolAt(const <type>Pool* pool, u32 index)` (no validity check)
+ * - `type* <type>PoolAdd(<type>Pool* pool, const type* object)`
+ * - `ObjectPoolRef <type>PoolAddRef(<type>Pool* pool, const type* object)`
+ * - `type* <type>PoolResolve(const <type>Pool* pool, ObjectPoolRef ref)`
+ * - `void <type>PoolRemove(<type>Pool* pool, u32 index)`
  *
- * ForEachObjectPoolObject(pool, float, itr) {
- *     printf("Iteration: %d. Entity: %.2f [%p]\n", itr.index, *itr.object, itr.object");
+ * Usage:
+ * ```
+ * DEFINE_OBJECT_POOL(Enemy)
+ *
+ * EnemyPool pool = EnemyPoolCreate(DATA_OBJECT_POOL_DEFAULT_PAGE_CHUNKS);
+ * EnemyPoolAdd(&pool, &(Enemy){0});
+ * ```
+ */
+#define DEFINE_OBJECT_POOL(type)                                                                                                            \
+    typedef struct type##Pool {                                                                                                             \
+        ObjectPool base;                                                                                                                    \
+    } type##Pool;                                                                                                                           \
+                                                                                                                                            \
+    _Static_assert(sizeof(type) >= sizeof(u32), "Typed pools need room for the free list link on every chunk");                             \
+                                                                                                                                            \
+    static inline type##Pool type##PoolCreate(u32 page_chunks) { return (type##Pool){ObjectPoolCreatePagedType(type, page_chunks)}; }       \
+    static inline void type##PoolDelete(type##Pool* pool) { ObjectPoolDelete(&pool->base); }                                                \
+    static inline type* type##PoolAt(const type##Pool* pool, u32 index) {                                                                   \
+        return (type*)pool->base.pages[index >> pool->base.page_shift] + (index & ((1u << pool->base.page_shift) - 1));                     \
+    }                                                                                                                                       \
+    static inline type* type##PoolAdd(type##Pool* pool, const type* object) {                                                               \
+        type* slot = type##PoolAt(pool, ObjectPoolChunkAcquire(&pool->base));                                                               \
+        *slot = *object;                                                                                                                    \
+        return slot;                                                                                                                        \
+    }                                                                                                                                       \
+    static inline ObjectPoolRef type##PoolAddRef(type##Pool* pool, const type* object) {                                                    \
+        u32 index = ObjectPoolChunkAcquire(&pool->base);                                                                                    \
+        *type##PoolAt(pool, index) = *object;                                                                                               \
+        return ObjectPoolRefAt(&pool->base, index);                                                                                         \
+    }                                                                                                                                       \
+    static inline type* type##PoolResolve(const type##Pool* pool, ObjectPoolRef ref) { return (type*)ObjectPoolResolve(&pool->base, ref); } \
+    static inline void type##PoolRemove(type##Pool* pool, u32 index) { ObjectPoolObjectRemove(&pool->base, index); }
+
+/**
+ * Custom for-each-loop to iterate over all the valid entities of a typed data object pool defined with `DEFINE_OBJECT_POOL`.
+ *
+ * @param pool Typed entity pool to use.
+ * @param type Type of the data object. Must be the same used to define the pool.
+ * @param iteration_var Name of the variable where all the iteration information will be stored.
+ * @param iteration_var.index `u32` Index of the current chunk.
+ * @param iteration_var.object `type *` Pointer to the object of the chunk.
+ *
+ * Usage:
+ * ```
+ * ForEachTypedPoolObject(&state->enemies, Enemy, itr) {
+ *     printf("Iteration: %u. Enemy health: %u\n", itr.index, itr.object->health.current);
  * }
  * ```
  */
-#define ForEachObjectPoolObject(pool, type, iteration_var)                                                          \
-    if ((pool)->chunk_count > 0)                                                                                    \
-        for (                                                                                                       \
-            struct {                                                                                                \
-                u32 index;                                                                                          \
-                type* object;                                                                                       \
-            } iteration_var = {0, (type*)(pool)->chunks};                                                           \
-            iteration_var.index < (pool)->chunk_count;                                                              \
-            ++iteration_var.index, iteration_var.object = (type*)((uptr)iteration_var.object + (pool)->chunk_size)) \
-            if (*(bool*)((uptr)iteration_var.object + (pool)->object_size))
+#define ForEachTypedPoolObject(pool, type, iteration_var)                                                                     \
+    for (                                                                                                                     \
+        struct {                                                                                                              \
+            u32 index;                                                                                                        \
+            type* object;                                                                                                     \
+        } iteration_var = {ObjectPoolNextValidChunk(&(pool)->base, 0), NULL};                                                 \
+        iteration_var.index < (pool)->base.chunk_count && (iteration_var.object = type##PoolAt((pool), iteration_var.index)); \
+        iteration_var.index = ObjectPoolNextValidChunk(&(pool)->base, iteration_var.index + 1))
 
 #endif  // DATA_OBJECT_POOL_H
@@ -1,13 +1,183 @@
 #include <stddef.h>
+#include <stdint.h>
 
 #include "utils/memory_utils.h"
 
+// Widest block moved at once: 32 bytes with AVX2, 16 bytes with SSE2 and 8 bytes otherwise.
+// Block loops store on aligned addresses, loads can be unaligned.
+#if defined(__AVX2__)
+
+#include <immintrin.h>
+
+typedef __m256i memory_block;
+#define MEMORY_BLOCK_LOAD(src)           _mm256_loadu_si256((const __m256i*)(src))
+#define MEMORY_BLOCK_STORE(dest, block)  _mm256_store_si256((__m256i*)(dest), (block))
+#define MEMORY_BLOCK_STOREU(dest, block) _mm256_storeu_si256((__m256i*)(dest), (block))
+#define MEMORY_BLOCK_SPLAT(value)        _mm256_set1_epi8((char)(value))
+
+#elif defined(__SSE2__)
+
+#include <emmintrin.h>
+
+typedef __m128i memory_block;
+#define MEMORY_BLOCK_LOAD(src)           _mm_loadu_si128((const __m128i*)(src))
+#define MEMORY_BLOCK_STORE(dest, block)  _mm_store_si128((__m128i*)(dest), (block))
+#define MEMORY_BLOCK_STOREU(dest, block) _mm_storeu_si128((__m128i*)(dest), (block))
+#define MEMORY_BLOCK_SPLAT(value)        _mm_set1_epi8((char)(value))
+
+#else
+
+typedef uint64_t __attribute__((may_alias)) memory_block;
+#define MEMORY_BLOCK_LOAD(src)           (*(const _memory_u64*)(src))
+#define MEMORY_BLOCK_STORE(dest, block)  (*(memory_block*)(dest) = (block))
+#define MEMORY_BLOCK_STOREU(dest, block) (*(_memory_u64*)(dest) = (block))
+#define MEMORY_BLOCK_SPLAT(value)        ((memory_block)(value) * 0x0101010101010101ULL)
+
+#endif
+
+#define MEMORY_BLOCK_SIZE sizeof(memory_block)
+
+// Unaligned words for the copies smaller than a block
+typedef uint64_t __attribute__((may_alias, aligned(1))) _memory_u64;
+typedef uint32_t __attribute__((may_alias, aligned(1))) _memory_u32;
+typedef uint16_t __attribute__((may_alias, aligned(1))) _memory_u16;
+
+// Copies less than a block (up to 32 bytes) with overlapping words. Both words are loaded before storing, so overlapping moves are safe.
+void _MemoryCopySmall(char* d, const char* s, size_t bytes) {
+    if (bytes >= 16) {
+        uint64_t head0 = *(const _memory_u64*)s, head1 = *(const _memory_u64*)(s + 8);
+        uint64_t tail0 = *(const _memory_u64*)(s + bytes - 16), tail1 = *(const _memory_u64*)(s + bytes - 8);
+        *(_memory_u64*)d = head0;
+        *(_memory_u64*)(d + 8) = head1;
+        *(_memory_u64*)(d + bytes - 16) = tail0;
+        *(_memory_u64*)(d + bytes - 8) = tail1;
+    } else if (bytes >= 8) {
+        uint64_t head = *(const _memory_u64*)s, tail = *(const _memory_u64*)(s + bytes - 8);
+        *(_memory_u64*)d = head;
+        *(_memory_u64*)(d + bytes - 8) = tail;
+    } else if (bytes >= 4) {
+        uint32_t head = *(const _memory_u32*)s, tail = *(const _memory_u32*)(s + bytes - 4);
+        *(_memory_u32*)d = head;
+        *(_memory_u32*)(d + bytes - 4) = tail;
+    } else if (bytes >= 2) {
+        uint16_t head = *(const _memory_u16*)s, tail = *(const _memory_u16*)(s + bytes - 2);
+        *(_memory_u16*)d = head;
+        *(_memory_u16*)(d + bytes - 2) = tail;
+    } else if (bytes == 1) {
+        *d = *s;
+    }
+}
+
 void* memory_copy(void* dest, const void* src, size_t bytes) {
-    for (char *d = dest, *s = (char*)src; bytes; --bytes, ++d, ++s) { *d = *s; }
+    char* d = dest;
+    const char* s = src;
+
+    if (bytes < 2 * MEMORY_BLOCK_SIZE) {
+        if (bytes >= MEMORY_BLOCK_SIZE) {
+            memory_block head = MEMORY_BLOCK_LOAD(s), tail = MEMORY_BLOCK_LOAD(s + bytes - MEMORY_BLOCK_SIZE);
+            MEMORY_BLOCK_STOREU(d, head);
+            MEMORY_BLOCK_STOREU(d + bytes - MEMORY_BLOCK_SIZE, tail);
+        } else {
+            _MemoryCopySmall(d, s, bytes);
+        }
+        return dest;
+    }
+
+    // Unaligned head and tail blocks, overlapped by the aligned blocks in between
+    memory_block tail = MEMORY_BLOCK_LOAD(s + bytes - MEMORY_BLOCK_SIZE);
+    MEMORY_BLOCK_STOREU(d, MEMORY_BLOCK_LOAD(s));
+    MEMORY_BLOCK_STOREU(d + bytes - MEMORY_BLOCK_SIZE, tail);
+
+    size_t prologue = MEMORY_BLOCK_SIZE - (size_t)((uintptr_t)d & (MEMORY_BLOCK_SIZE - 1));
+    d += prologue;
+    s += prologue;
+    bytes -= prologue;
+
+    for (; bytes >= 4 * MEMORY_BLOCK_SIZE; bytes -= 4 * MEMORY_BLOCK_SIZE, d += 4 * MEMORY_BLOCK_SIZE, s += 4 * MEMORY_BLOCK_SIZE) {
+        memory_block b0 = MEMORY_BLOCK_LOAD(s), b1 = MEMORY_BLOCK_LOAD(s + MEMORY_BLOCK_SIZE);
+        memory_block b2 = MEMORY_BLOCK_LOAD(s + 2 * MEMORY_BLOCK_SIZE), b3 = MEMORY_BLOCK_LOAD(s + 3 * MEMORY_BLOCK_SIZE);
+        MEMORY_BLOCK_STORE(d, b0);
+        MEMORY_BLOCK_STORE(d + MEMORY_BLOCK_SIZE, b1);
+        MEMORY_BLOCK_STORE(d + 2 * MEMORY_BLOCK_SIZE, b2);
+        MEMORY_BLOCK_STORE(d + 3 * MEMORY_BLOCK_SIZE, b3);
+    }
+    for (; bytes >= MEMORY_BLOCK_SIZE; bytes -= MEMORY_BLOCK_SIZE, d += MEMORY_BLOCK_SIZE, s += MEMORY_BLOCK_SIZE) {
+        MEMORY_BLOCK_STORE(d, MEMORY_BLOCK_LOAD(s));
+    }
+
     return dest;
 }
 
-void* memory_zero(void* memory, size_t bytes) {
-    for (char* m = memory; bytes; --bytes, ++m) { *m = 0; }
+// Copies from the start to the end, for overlapping moves where the destination is before the source
+void _MemoryCopyForwards(char* d, const char* s, size_t bytes) {
+    if (bytes >= MEMORY_BLOCK_SIZE) {
+        for (size_t prologue = (size_t)(-(uintptr_t)d & (MEMORY_BLOCK_SIZE - 1)); prologue; --prologue, --bytes) { *(d++) = *(s++); }
+
+        for (; bytes >= MEMORY_BLOCK_SIZE; bytes -= MEMORY_BLOCK_SIZE, d += MEMORY_BLOCK_SIZE, s += MEMORY_BLOCK_SIZE) {
+            MEMORY_BLOCK_STORE(d, MEMORY_BLOCK_LOAD(s));
+        }
+    }
+    for (; bytes; --bytes) { *(d++) = *(s++); }
+}
+
+// Copies from the end to the start, for overlapping moves where the destination is after the source
+void _MemoryCopyBackwards(char* d, const char* s, size_t bytes) {
+    d += bytes;
+    s += bytes;
+
+    if (bytes >= MEMORY_BLOCK_SIZE) {
+        for (size_t epilogue = (size_t)((uintptr_t)d & (MEMORY_BLOCK_SIZE - 1)); epilogue; --epilogue, --bytes) { *(--d) = *(--s); }
+
+        for (; bytes >= MEMORY_BLOCK_SIZE; bytes -= MEMORY_BLOCK_SIZE) {
+            d -= MEMORY_BLOCK_SIZE;
+            s -= MEMORY_BLOCK_SIZE;
+            MEMORY_BLOCK_STORE(d, MEMORY_BLOCK_LOAD(s));
+        }
+    }
+    for (; bytes; --bytes) { *(--d) = *(--s); }
+}
+
+void* memory_move(void* dest, const void* src, size_t bytes) {
+    uintptr_t d = (uintptr_t)dest, s = (uintptr_t)src;
+
+    if (bytes < MEMORY_BLOCK_SIZE) {
+        _MemoryCopySmall(dest, src, bytes);
+    } else if (d - s >= bytes && s - d >= bytes) {
+        memory_copy(dest, src, bytes);  // No overlap
+    } else if (d < s) {
+        _MemoryCopyForwards(dest, src, bytes);
+    } else {
+        _MemoryCopyBackwards(dest, src, bytes);
+    }
+    return dest;
+}
+
+void* memory_fill(void* memory, unsigned char value, size_t bytes) {
+    char* m = memory;
+
+    if (bytes < MEMORY_BLOCK_SIZE) {
+        for (; bytes; --bytes) { *(m++) = value; }
+        return memory;
+    }
+
+    // Unaligned head and tail blocks, overlapped by the aligned blocks in between
+    memory_block block = MEMORY_BLOCK_SPLAT(value);
+    MEMORY_BLOCK_STOREU(m, block);
+    MEMORY_BLOCK_STOREU(m + bytes - MEMORY_BLOCK_SIZE, block);
+
+    size_t prologue = MEMORY_BLOCK_SIZE - (size_t)((uintptr_t)m & (MEMORY_BLOCK_SIZE - 1));
+    m += prologue;
+    bytes -= prologue;
+
+    for (; bytes >= 4 * MEMORY_BLOCK_SIZE; bytes -= 4 * MEMORY_BLOCK_SIZE, m += 4 * MEMORY_BLOCK_SIZE) {
+        MEMORY_BLOCK_STORE(m, block);
+        MEMORY_BLOCK_STORE(m + MEMORY_BLOCK_SIZE, block);
+        MEMORY_BLOCK_STORE(m + 2 * MEMORY_BLOCK_SIZE, block);
+        MEMORY_BLOCK_STORE(m + 3 * MEMORY_BLOCK_SIZE, block);
+    }
+    for (; bytes >= MEMORY_BLOCK_SIZE; bytes -= MEMORY_BLOCK_SIZE, m += MEMORY_BLOCK_SIZE) { MEMORY_BLOCK_STORE(m, block); }
+
     return memory;
 }
+
+void* memory_zero(void* memory, size_t bytes) { return memory_fill(memory, 0, bytes); }
@@ -21,6 +21,23 @@ void *memory_copy(void *dest, const void *src, size_t bytes);
  */
 #define memory_copy_type(dest, src, type) ((type *)memory_copy(dest, src, sizeof(type)))
 
+/**
+ * Copies the specified number of bytes from a source to a destination. The memory spaces can overlap.
+ * @param dest Destination memory space.
+ * @param src Source memory space.
+ * @param bytes Number of bytes to copy.
+ * @return Reference to the destination memory space.
+ */
+void *memory_move(void *dest, const void *src, size_t bytes);
+
+/**
+ * Sets the specified number of bytes from a memory space to a value.
+ * @param memory Memory space.
+ * @param value Value to set on every byte.
+ * @param bytes Number of bytes update.
+ * @return Reference to the memory space.
+ */
+void *memory_fill(void *memory, unsigned char value, size_t bytes);
 /**
  * Sets the specified number of bytes from a memory space to 0.
  * @param memory Memory space.
@@ -0,0 +1,49 @@
+#include "utils/random.h"
+#include "utils/memory_utils.h"
+#include "types/types.h"
+
+#define RANDOM_MULTIPLIER 6364136223846793005ULL
+#define RANDOM_INCREMENT  1442695040888963407ULL
+#define HASH_PRIME        0x100000001b3ULL  // FNV-1a prime
+
+Random RandomCreate(u64 seed) {
+    Random random = {.state = 0};
+    RandomNext(&random);
+    random.state += seed;
+    RandomNext(&random);
+    return random;
+}
+
+u32 RandomNext(Random* random) {
+    u64 state = random->state;
+    random->state = state * RANDOM_MULTIPLIER + RANDOM_INCREMENT;
+
+    // Permuted output: xorshift of the high bits, rotated by the top 5 bits
+    u32 xorshifted = (u32)(((state >> 18) ^ state) >> 27);
+    u32 rotation = (u32)(state >> 59);
+    return (xorshifted >> rotation) | (xorshifted << ((-rotation) & 31));
+}
+
+i32 RandomValue(Random* random, i32 min, i32 max) {
+    if (min > max) {
+        i32 swap = min;
+        min = max;
+        max = swap;
+    }
+    u64 range = (u64)((i64)max - (i64)min) + 1;
+    return (i32)((i64)min + (i64)(RandomNext(random) % range));
+}
+
+u64 HashBytes(u64 hash, const void* bytes, usize count) {
+    const byte* b = bytes;
+
+    for (; count >= sizeof(u64); count -= sizeof(u64), b += sizeof(u64)) {
+        u64 word;
+        memory_copy(&word, b, sizeof(u64));
+        hash = (hash ^ word) * HASH_PRIME;
+        hash ^= hash >> 32;
+    }
+    for (; count > 0; --count, ++b) { hash = (hash ^ (u8)*b) * HASH_PRIME; }
+
+    return hash;
+}
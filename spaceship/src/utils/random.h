@@ -0,0 +1,58 @@
+#pragma once
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include "types/types.h"
+
+// ----------------------------------------------------------------------------
+// ---- Random ----------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+/**
+ * Pseudorandom number generator (PCG32). The sequence only depends on the seed, so it is the same on every run and platform.
+ */
+typedef struct Random {
+    u64 state;
+} Random;
+
+/**
+ * Creates a pseudorandom number generator.
+ * @param seed Seed of the sequence.
+ * @return New generator.
+ */
+Random RandomCreate(u64 seed);
+/**
+ * Gets the next number of the sequence.
+ * @param random Generator to advance.
+ * @return Number from 0 to `UINT32_MAX`.
+ */
+u32 RandomNext(Random* random);
+/**
+ * Gets the next number of the sequence inside a range.
+ * @param random Generator to advance.
+ * @param min Minimum value, included.
+ * @param max Maximum value, included.
+ * @return Number from `min` to `max`.
+ */
+i32 RandomValue(Random* random, i32 min, i32 max);
+
+/**
+ * Hashes some bytes, chained from a previous hash (FNV-1a over 64 bit words).
+ * @param hash Previous hash, or `HASH_INITIAL` to start a new one.
+ * @param bytes Bytes to hash.
+ * @param count Number of bytes.
+ * @return New hash.
+ */
+u64 HashBytes(u64 hash, const void* bytes, usize count);
+
+#define HASH_INITIAL 0xcbf29ce484222325ULL  // FNV-1a offset basis
+
+/**
+ * Hashes a value, chained from a previous hash.
+ * @param hash Previous hash.
+ * @param value Value to hash. Must be an lvalue without padding bytes.
+ * @return New hash.
+ */
+#define HashValue(hash, value) HashBytes((hash), &(value), sizeof(value))
+
+#endif  // RANDOM_H